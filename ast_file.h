@@ -0,0 +1,91 @@
+#ifndef AST_FILE_H
+#define AST_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* On-disk form of the tree built by mk_node/ext_node, written by
+   `parser --emit-ast`. Everything is addressed by byte offsets from
+   the start of its section, so the file can be mapped anywhere and
+   read in place.
+
+     header | kind table | nodes | strings
+
+   The kind table holds one string offset per node kind, so readers do
+   not depend on the numbering in node_kinds.h. Each node is an
+   ast_file_node followed by n_elems child offsets into the node
+   section; children are written before their parents. An atom (kind
+   0) has no children and its text is in the string table; strings are
+   NUL-terminated there as well. */
+
+#define AST_FILE_MAGIC "RSAS"
+#define AST_FILE_VERSION 1
+
+struct ast_file_header {
+  char magic[4];
+  uint32_t version;
+  uint32_t n_kinds;
+  uint32_t kinds_offset;
+  uint32_t nodes_offset;
+  uint32_t nodes_size;
+  uint32_t strings_offset;
+  uint32_t strings_size;
+  uint32_t root;
+  uint32_t n_nodes;
+};
+
+struct ast_file_node {
+  uint32_t kind;
+  uint32_t n_elems;
+  uint32_t text;
+  uint32_t text_len;
+  uint32_t elems[];
+};
+
+/* A mapped AST file. The accessors below only do pointer arithmetic;
+   ast_file_open checks the header, the section bounds and every node's
+   kind, text and child offsets once. */
+struct ast_file {
+  void *base;
+  size_t size;
+  struct ast_file_header const *hdr;
+  uint32_t const *kinds;
+  char const *nodes;
+  char const *strings;
+};
+
+/* Returns 0, or -1 with errno set (EINVAL if path is not an AST file
+   of this version). */
+int ast_file_open(struct ast_file *f, char const *path);
+void ast_file_close(struct ast_file *f);
+
+static inline struct ast_file_node const *ast_file_root(struct ast_file const *f) {
+  return (struct ast_file_node const *)(f->nodes + f->hdr->root);
+}
+
+static inline struct ast_file_node const *ast_file_child(struct ast_file const *f,
+                                                         struct ast_file_node const *n,
+                                                         uint32_t i) {
+  return (struct ast_file_node const *)(f->nodes + n->elems[i]);
+}
+
+static inline char const *ast_file_kind_name(struct ast_file const *f,
+                                             struct ast_file_node const *n) {
+  return f->strings + f->kinds[n->kind];
+}
+
+/* An atom's text, or the kind name for any other node. */
+static inline char const *ast_file_text(struct ast_file const *f,
+                                        struct ast_file_node const *n) {
+  return f->strings + n->text;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,107 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ast_file.h"
+
+static int in_bounds(uint64_t off, uint64_t len, uint64_t size) {
+  return off <= size && len <= size - off;
+}
+
+static int check_header(struct ast_file *f) {
+  struct ast_file_header const *h = (struct ast_file_header const *)f->base;
+  if (f->size < sizeof(*h) || memcmp(h->magic, AST_FILE_MAGIC, 4) != 0 ||
+      h->version != AST_FILE_VERSION ||
+      h->kinds_offset % 4 || h->nodes_offset % 4 ||
+      !in_bounds(h->kinds_offset, (uint64_t)h->n_kinds * 4, f->size) ||
+      !in_bounds(h->nodes_offset, h->nodes_size, f->size) ||
+      !in_bounds(h->strings_offset, h->strings_size, f->size) ||
+      h->strings_size == 0 || h->root >= h->nodes_size) {
+    return -1;
+  }
+  f->hdr = h;
+  f->kinds = (uint32_t const *)((char const *)f->base + h->kinds_offset);
+  f->nodes = (char const *)f->base + h->nodes_offset;
+  f->strings = (char const *)f->base + h->strings_offset;
+  if (f->strings[h->strings_size - 1] != '\0') {
+    return -1;
+  }
+  for (uint32_t k = 0; k < h->n_kinds; ++k) {
+    if (f->kinds[k] >= h->strings_size) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+/* Walks the node section, which holds nothing but nodes end to end.
+   Each node's kind and text must be in their tables, and each child
+   must be a node that starts earlier in the section. */
+static int check_nodes(struct ast_file *f) {
+  uint32_t size = f->hdr->nodes_size;
+  unsigned char *starts = (unsigned char *)calloc(size / 32 + 1, 1);
+  uint32_t off = 0, count = 0;
+  int ok = starts != NULL && size % 4 == 0;
+
+  while (ok && off < size) {
+    struct ast_file_node const *n = (struct ast_file_node const *)(f->nodes + off);
+    if (!in_bounds(off, sizeof(*n), size) ||
+        !in_bounds(off + sizeof(*n), (uint64_t)n->n_elems * 4, size) ||
+        n->kind >= f->hdr->n_kinds ||
+        !in_bounds(n->text, (uint64_t)n->text_len + 1, f->hdr->strings_size) ||
+        f->strings[n->text + n->text_len] != '\0') {
+      ok = 0;
+      break;
+    }
+    for (uint32_t i = 0; ok && i < n->n_elems; ++i) {
+      uint32_t c = n->elems[i];
+      ok = c < off && c % 4 == 0 && (starts[c / 32] >> (c / 4 % 8) & 1);
+    }
+    starts[off / 32] |= 1 << (off / 4 % 8);
+    off += sizeof(*n) + n->n_elems * 4;
+    ++count;
+  }
+  ok = ok && count == f->hdr->n_nodes && f->hdr->root % 4 == 0 &&
+       (starts[f->hdr->root / 32] >> (f->hdr->root / 4 % 8) & 1);
+  free(starts);
+  return ok ? 0 : -1;
+}
+
+int ast_file_open(struct ast_file *f, char const *path) {
+  struct stat st;
+  int fd = open(path, O_RDONLY);
+
+  memset(f, 0, sizeof(*f));
+  if (fd < 0) {
+    return -1;
+  }
+  if (fstat(fd, &st)) {
+    close(fd);
+    return -1;
+  }
+  f->size = st.st_size;
+  f->base = f->size ? mmap(NULL, f->size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+  close(fd);
+  if (f->base == MAP_FAILED) {
+    f->base = NULL;
+    errno = f->size ? errno : EINVAL;
+    return -1;
+  }
+  if (check_header(f) || check_nodes(f)) {
+    ast_file_close(f);
+    errno = EINVAL;
+    return -1;
+  }
+  return 0;
+}
+
+void ast_file_close(struct ast_file *f) {
+  if (f->base) {
+    munmap(f->base, f->size);
+  }
+  memset(f, 0, sizeof(*f));
+}
@@ -0,0 +1,94 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "session.h"
+#include "ast_file.h"
+#include "walk.h"
+
+using namespace std;
+
+/* Builds the node and string sections of an AST file in memory.
+   Nodes reachable along several paths are written once. */
+struct ast_writer {
+  vector<uint32_t> nodes;
+  string strings;
+  unordered_map<string, uint32_t> string_offsets;
+  unordered_map<struct node const *, uint32_t> node_offsets;
+};
+
+static uint32_t add_string(struct ast_writer *w, char const *str, size_t len) {
+  string key(str, len);
+  auto it = w->string_offsets.find(key);
+  if (it != w->string_offsets.end()) {
+    return it->second;
+  }
+  uint32_t off = w->strings.size();
+  w->strings.append(key);
+  w->strings.push_back('\0');
+  w->string_offsets.emplace(key, off);
+  return off;
+}
+
+/* Nodes are written after their children, so each one can list its
+   children's offsets; those wait on a stack of their own until the
+   parent is left. */
+static uint32_t write_node(struct ast_writer *w, struct node *root) {
+  vector<struct walk_frame<struct walk_none> > stack;
+  vector<uint32_t> offsets;
+  auto enter = [w](struct node *n, struct walk_none const &, struct walk_none &) {
+    return w->node_offsets.count(n) ? 0 : 1;
+  };
+  auto leave = [w, &offsets](struct node *n, struct walk_none const &) {
+    auto it = w->node_offsets.find(n);
+    if (it != w->node_offsets.end()) {
+      offsets.push_back(it->second);
+      return;
+    }
+    uint32_t off = w->nodes.size() * sizeof(uint32_t);
+    w->nodes.push_back(n->kind);
+    w->nodes.push_back(n->n_elems);
+    w->nodes.push_back(add_string(w, n->name, n->name_len));
+    w->nodes.push_back(n->name_len);
+    w->nodes.insert(w->nodes.end(), offsets.end() - n->n_elems, offsets.end());
+    offsets.resize(offsets.size() - n->n_elems);
+    offsets.push_back(off);
+    w->node_offsets.emplace(n, off);
+  };
+  walk(stack, root, walk_none(), enter, leave);
+  return offsets.back();
+}
+
+int write_ast_file(struct session *sess, FILE *out) {
+  struct ast_writer w;
+  struct ast_file_header h;
+  uint32_t kinds[NK_COUNT];
+
+  if (!sess->ast_root) {
+    return -1;
+  }
+  for (int k = 0; k < NK_COUNT; ++k) {
+    kinds[k] = add_string(&w, node_kind_names[k], strlen(node_kind_names[k]));
+  }
+  h.root = write_node(&w, sess->ast_root);
+
+  memcpy(h.magic, AST_FILE_MAGIC, 4);
+  h.version = AST_FILE_VERSION;
+  h.n_kinds = NK_COUNT;
+  h.kinds_offset = sizeof(h);
+  h.nodes_offset = h.kinds_offset + sizeof(kinds);
+  h.nodes_size = w.nodes.size() * sizeof(uint32_t);
+  h.strings_offset = h.nodes_offset + h.nodes_size;
+  h.strings_size = w.strings.size();
+  h.n_nodes = w.node_offsets.size();
+
+  if (fwrite(&h, sizeof(h), 1, out) != 1 ||
+      fwrite(kinds, sizeof(kinds), 1, out) != 1 ||
+      fwrite(w.nodes.data(), sizeof(uint32_t), w.nodes.size(), out) != w.nodes.size() ||
+      fwrite(w.strings.data(), 1, w.strings.size(), out) != w.strings.size()) {
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,72 @@
+#!/bin/sh
+# Times lexing, parsing and full checking of synthetic crates written
+# by gen_corpus, one shape at a time.
+#
+# usage: bench.sh [bin dir] [work dir]
+#
+# Every phase is run once to warm the cache and then REPEAT times
+# (default 7); the table shows the median, with min and max to judge
+# the spread. SCALE (default 1) multiplies the size of every crate.
+
+BIN=${1:-bin}
+WORK=${2:-build/bench}
+REPEAT=${REPEAT:-7}
+SCALE=${SCALE:-1}
+
+mkdir -p "$WORK" || exit 1
+
+# name and gen_corpus options of each shape; -n is scaled.
+shapes="functions:-n_20000_-l_4_-d_1
+nesting:-n_2000_-l_4_-d_6
+long_exprs:-n_2000_-e_64
+locals:-n_200_-l_400
+comments:-n_5000_-c_90"
+
+now() {
+  date +%s%N
+}
+
+# Run a command REPEAT times and print the median, min and max in ns.
+time_runs() {
+  "$@" > /dev/null 2>&1
+  i=0
+  while [ $i -lt "$REPEAT" ]; do
+    t0=$(now)
+    "$@" > /dev/null 2>&1
+    t1=$(now)
+    echo $((t1 - t0))
+    i=$((i + 1))
+  done | sort -n | awk '{ t[NR] = $1 } END { print t[int((NR + 1) / 2)], t[1], t[NR] }'
+}
+
+report() {
+  # shape phase bytes nodes median min max
+  awk -v shape="$1" -v phase="$2" -v bytes="$3" -v nodes="$4" \
+      -v med="$5" -v min="$6" -v max="$7" 'BEGIN {
+    s = med / 1e9
+    mbs = bytes / 1048576 / s
+    if (nodes > 0) {
+      nps = sprintf("%12.0f", nodes / s)
+    } else {
+      nps = sprintf("%12s", "-")
+    }
+    printf "%-11s %-6s %9.3f %9.3f %9.3f %9.2f %s\n", shape, phase, med / 1e6, min / 1e6, max / 1e6, mbs, nps
+  }'
+}
+
+printf "%-11s %-6s %9s %9s %9s %9s %12s\n" shape phase "med ms" "min ms" "max ms" "MB/s" "nodes/s"
+for entry in $shapes; do
+  name=${entry%%:*}
+  opts=$(echo "${entry#*:}" | tr _ ' ')
+  n=$(echo "$opts" | sed 's/.*-n \([0-9]*\).*/\1/')
+  opts=$(echo "$opts" | sed "s/-n [0-9]*/-n $((n * SCALE))/")
+  file=$WORK/$name.rs
+  "$BIN/gen_corpus" $opts > "$file" || exit 1
+  bytes=$(wc -c < "$file")
+  # n_nodes comes from the parser's phase trace; builds with TRACE=0
+  # have none and leave nodes/s blank.
+  nodes=$("$BIN/parser" --parse-only --trace parser:1 "$file" | sed -n 's/.*n_nodes:\([0-9]*\).*/\1/p')
+  report "$name" lex "$bytes" 0 $(time_runs "$BIN/lexer" --binary "$file")
+  report "$name" parse "$bytes" "${nodes:-0}" $(time_runs "$BIN/parser" --parse-only "$file")
+  report "$name" check "$bytes" "${nodes:-0}" $(time_runs "$BIN/parser" "$file")
+done
@@ -0,0 +1,74 @@
+#!/bin/sh
+# Checks the push parser that reads stdin: every sample piped in a line
+# at a time must give the report it gives as a file, and a lexer error
+# must be reported before the writer sends the rest of the input.
+#
+# usage: check.sh [bin dir] [work dir]
+#
+# The lines are sent DELAY seconds (default 0.01) apart.
+
+BIN=${1:-bin}
+WORK=${2:-build/check}
+DELAY=${DELAY:-0.01}
+
+mkdir -p "$WORK" || exit 1
+fail=0
+
+# Write file $1 to stdout a line every $2 seconds; a reader that is
+# done early is not an error.
+trickle() {
+  trap '' PIPE
+  while IFS= read -r line; do
+    printf '%s\n' "$line"
+    sleep "$2"
+  done < "$1"
+}
+
+# Reports differ only in the file name header, in addresses and in the
+# arena line, since text scanned from a piece is copied into the arena.
+normalize() {
+  sed '/^==> .* <==$/d; /^--- ARENA:/d; s/0x[0-9a-f]*/PTR/g' "$1"
+}
+
+for f in inp*.txt input.txt; do
+  for opts in "" -v; do
+    "$BIN/parser" $opts "$f" > "$WORK/file.out" 2>&1
+    file_status=$?
+    trickle "$f" "$DELAY" 2> /dev/null | "$BIN/parser" $opts > "$WORK/pipe.out" 2>&1
+    pipe_status=$?
+    normalize "$WORK/file.out" > "$WORK/file.norm"
+    normalize "$WORK/pipe.out" > "$WORK/pipe.norm"
+    if [ $file_status != $pipe_status ] || ! cmp -s "$WORK/file.norm" "$WORK/pipe.norm"; then
+      echo "check: parser $opts $f: stdin and file reports differ"
+      fail=1
+    fi
+  done
+done
+
+# inp10.txt has a bad escape on line 6. The writer sends up to that
+# line, then waits for the parser to exit before it sends the rest; if
+# the parser is still reading after 10 seconds, the writer gives up,
+# notes that and goes on.
+rm -f "$WORK/done" "$WORK/late"
+{
+  trap '' PIPE
+  sed -n '1,6p' inp10.txt
+  i=0
+  while [ ! -f "$WORK/done" ] && [ $i -lt 1000 ]; do
+    sleep 0.01
+    i=$((i + 1))
+  done
+  [ -f "$WORK/done" ] || : > "$WORK/late"
+  sed '1,6d' inp10.txt
+} 2> /dev/null | { "$BIN/parser" > "$WORK/inp10.out" 2>&1; : > "$WORK/done"; }
+if [ -f "$WORK/late" ]; then
+  echo "check: inp10.txt: the lexer error was not reported before the rest of the input"
+  fail=1
+fi
+if ! grep -q "syntax error" "$WORK/inp10.out"; then
+  echo "check: inp10.txt: no syntax error reported"
+  fail=1
+fi
+
+[ $fail = 0 ] && echo "check: ok"
+exit $fail
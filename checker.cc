@@ -0,0 +1,2079 @@
+#include <cstdio>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <utility>
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <climits>
+#include <ctime>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#define NODE_KINDS_IMPL
+#include "session.h"
+#include "semanticrs.h"
+#include "walk.h"
+#include "emit.h"
+
+using namespace std;
+
+extern int rsparse(struct session *sess);
+extern int push_token(struct session *sess, int token, struct src_span *loc);
+extern void push_parser_free(struct session *sess);
+
+// Name and canonical type of every type_id. A declared width keeps
+// its own id in the symbol table; checks compare canonical types.
+static struct {
+  char const *name;
+  int canon;
+} const type_table[TY_COUNT] = {
+  {"", TY_NONE},
+  {"integer", TY_INTEGER},
+  {"float", TY_FLOAT},
+  {"string", TY_STRING},
+  {"bool", TY_BOOL},
+  {"func_decl", TY_FUNC},
+  {"i8", TY_INTEGER}, {"i16", TY_INTEGER}, {"i32", TY_INTEGER}, {"i64", TY_INTEGER},
+  {"u8", TY_INTEGER}, {"u16", TY_INTEGER}, {"u32", TY_INTEGER}, {"u64", TY_INTEGER},
+  {"f32", TY_FLOAT}, {"f64", TY_FLOAT}
+};
+
+// Type names a declaration may use, besides the canonical names.
+static struct {
+  char const *name;
+  int type;
+} const type_aliases[] = {
+  {"LitStr", TY_STRING},
+  {"LitBool", TY_BOOL},
+  {"LitFloat", TY_FLOAT},
+  {"LitInteger", TY_INTEGER}
+};
+
+// Resolve a declared type name once; TY_NONE if it names no type.
+static int type_of_name(char const *name) {
+  for (int t = TY_INTEGER; t < TY_COUNT; ++t) {
+    if (t != TY_FUNC && strcmp(name, type_table[t].name) == 0) {
+      return t;
+    }
+  }
+  for (auto &a : type_aliases) {
+    if (strcmp(name, a.name) == 0) {
+      return a.type;
+    }
+  }
+  return TY_NONE;
+}
+
+static int type_of_lit(struct node *lit) {
+  switch (lit ? lit->kind : NK_atom) {
+  case NK_LitInteger: return TY_INTEGER;
+  case NK_LitFloat: return TY_FLOAT;
+  case NK_LitStr: return TY_STRING;
+  case NK_LitBool: return TY_BOOL;
+  default: return TY_NONE;
+  }
+}
+
+static inline int type_canon(int type) {
+  return type_table[type].canon;
+}
+
+// What type compatibility is decided on: the canonical type, with
+// functions counted as untyped.
+static inline int type_class(int type) {
+  return type == TY_FUNC ? TY_NONE : type_table[type].canon;
+}
+
+static inline char const *type_name(int type) {
+  return type_table[type_canon(type)].name;
+}
+
+static unsigned long long now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int scan_token(struct session *sess, struct src_span *lloc) {
+  int token;
+  if (sess->stats.enabled) {
+    unsigned long long t0 = now_ns();
+    token = yylex(sess->scanner);
+    sess->stats.lex_ns += now_ns() - t0;
+  } else {
+    token = yylex(sess->scanner);
+  }
+  if (token > 0 && sess->scan_base) {
+    lloc->start = yyget_text(sess->scanner) - sess->scan_base + sess->scan_offset;
+    lloc->end = lloc->start + yyget_leng(sess->scanner);
+  }
+  return token;
+}
+
+// Dequeue the char at the head of the pushback queue, shifting the
+// rest forwards; 0 when the queue is empty.
+static int pop_pushback(struct session *sess) {
+  char *pushback = sess->pushback;
+  char c = pushback[0];
+  if (c != '\0') {
+    memmove(pushback, pushback + 1, PUSHBACK_LEN - 1);
+    pushback[PUSHBACK_LEN - 1] = '\0';
+  }
+  return c;
+}
+
+// A pushed back char comes before the next token from yylex. It keeps
+// the span of the token it was split from.
+int rslex(struct node **lval, struct src_span *lloc, struct session *sess) {
+  int c = pop_pushback(sess);
+  return c ? c : scan_token(sess, lloc);
+}
+
+// Move a parser stack of used bytes into buf, which it shares with
+// nothing else, and make room there for size bytes.
+void *grow_parse_stack(std::vector<char> &buf, void const *stack, size_t used, size_t size) {
+  if (stack != buf.data()) {
+    buf.assign((char const *)stack, (char const *)stack + used);
+  }
+  buf.resize(size);
+  return buf.data();
+}
+
+// note: this does nothing if the pushback queue is full
+void push_back(struct session *sess, char c) {
+  char *pushback = sess->pushback;
+  for (int i = 0; i < PUSHBACK_LEN; ++i) {
+    if (pushback[i] == '\0') {
+      pushback[i] = c;
+      break;
+    }
+  }
+}
+
+void *arena_alloc(struct arena *a, size_t sz) {
+  struct arena_block *b = a->head;
+  sz = (sz + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+  if (!b || b->size - b->used < sz) {
+    size_t bsz = sz > ARENA_BLOCK_SIZE ? sz : ARENA_BLOCK_SIZE;
+    if (bsz == ARENA_BLOCK_SIZE && a->spare) {
+      b = a->spare;
+      a->spare = b->next;
+      a->n_spare--;
+    } else {
+      b = (struct arena_block *)malloc(sizeof(struct arena_block) + bsz);
+    }
+    if (!b) {
+      fprintf(stderr, "out of memory\n");
+      abort();
+    }
+    b->size = bsz;
+    b->used = 0;
+    // Keep a partly used head block in front of an oversized one so
+    // its remaining space is still handed out.
+    if (a->head && bsz > ARENA_BLOCK_SIZE) {
+      b->next = a->head->next;
+      a->head->next = b;
+    } else {
+      b->next = a->head;
+      a->head = b;
+    }
+    a->n_blocks++;
+    a->bytes_reserved += bsz;
+  }
+  void *p = b->data + b->used;
+  b->used += sz;
+  a->n_allocs++;
+  a->bytes_used += sz;
+  return p;
+}
+
+char *arena_strndup(struct arena *a, char const *str, size_t len) {
+  char *p = (char *)arena_alloc(a, len + 1);
+  memcpy(p, str, len);
+  p[len] = '\0';
+  return p;
+}
+
+char *arena_strdup(struct arena *a, char const *str) {
+  return arena_strndup(a, str, strlen(str));
+}
+
+void arena_free(struct arena *a) {
+  arena_reset(a);
+  struct arena_block *b = a->spare;
+  while (b) {
+    struct arena_block *next = b->next;
+    free(b);
+    b = next;
+  }
+  memset(a, 0, sizeof(*a));
+}
+
+void arena_reset(struct arena *a) {
+  struct arena_block *b = a->head;
+  while (b) {
+    struct arena_block *next = b->next;
+    if (b->size == ARENA_BLOCK_SIZE && a->n_spare < ARENA_KEEP_BLOCKS) {
+      b->next = a->spare;
+      a->spare = b;
+      a->n_spare++;
+    } else {
+      free(b);
+    }
+    b = next;
+  }
+  a->head = NULL;
+  a->n_allocs = 0;
+  a->n_blocks = 0;
+  a->bytes_used = 0;
+  a->bytes_reserved = 0;
+}
+
+static unsigned hash_string(char const *str, size_t len) {
+  unsigned h = 2166136261u;
+  while (len--) {
+    h = (h ^ (unsigned char)*str++) * 16777619u;
+  }
+  return h;
+}
+
+static void intern_grow(struct intern_table *t) {
+  unsigned cap = t->cap ? t->cap * 2 : 256;
+  char const **slots = (char const **)calloc(cap, sizeof(char const *));
+  for (unsigned i = 0; i < t->cap; ++i) {
+    if (t->slots[i]) {
+      unsigned h = hash_string(t->slots[i], strlen(t->slots[i])) & (cap - 1);
+      while (slots[h]) {
+        h = (h + 1) & (cap - 1);
+      }
+      slots[h] = t->slots[i];
+    }
+  }
+  free(t->slots);
+  t->slots = slots;
+  t->cap = cap;
+}
+
+// str need not be NUL-terminated; atoms taken from a mapped source
+// only carry a length.
+char const *intern(struct intern_table *names, char const *str, size_t len) {
+  if (2 * (names->count + 1) > names->cap) {
+    intern_grow(names);
+  }
+  unsigned h = hash_string(str, len) & (names->cap - 1);
+  while (names->slots[h]) {
+    char const *slot = names->slots[h];
+    if (strncmp(slot, str, len) == 0 && slot[len] == '\0') {
+      return slot;
+    }
+    h = (h + 1) & (names->cap - 1);
+  }
+  names->count++;
+  return names->slots[h] = arena_strndup(&names->strings, str, len);
+}
+
+void intern_free(struct intern_table *names) {
+  free(names->slots);
+  arena_free(&names->strings);
+  memset(names, 0, sizeof(*names));
+}
+
+static struct node *alloc_node(struct session *sess, int cap) {
+  unsigned sz = sizeof(struct node) + (cap * sizeof(struct node *));
+  struct node *nd = (struct node *)arena_alloc(&sess->ast_arena, sz);
+  nd->n_cap = cap;
+  return nd;
+}
+
+static struct node *new_node(struct session *sess, int kind, char const *name,
+                             int name_len, int n) {
+  struct node *nd = alloc_node(sess, n);
+
+  TRACE(sess, TRACE_NODES, 2, "# New %d-ary node: %.*s = %p\n", n, name_len, name, (void *)nd);
+
+  nd->kind = kind;
+  nd->name = name;
+  nd->name_len = name_len;
+  nd->ident = NULL;
+  nd->lit = NULL;
+  nd->int_lit.value = 0;
+  nd->int_lit.suffix = INT_SUFFIX_NONE;
+  nd->int_lit.overflow = 0;
+  nd->n_elems = n;
+  nd->start = sess->rule_span.start;
+  nd->end = sess->rule_span.end;
+  sess->n_nodes++;
+  return nd;
+}
+
+// Fill nd's slots from a newly attached child if they are still empty,
+// which keeps them equal to the first match in a preorder walk.
+static void take_slots(struct node *nd, struct node *child) {
+  if (!nd->ident) {
+    nd->ident = child->ident;
+  }
+  if (!nd->lit) {
+    nd->lit = child->lit;
+  }
+}
+
+static char const no_ident[] = "";
+
+static inline char const *ident_of(struct node *n) {
+  return n->ident ? n->ident : no_ident;
+}
+
+// Kind names are only kept on the node for printing; every pass
+// dispatches on the integer kind.
+static struct node *vmk_node(struct session *sess, int kind, int n, va_list ap) {
+  int i = 0;
+  char const *name = node_kind_names[kind];
+  struct node *nn, *nd = new_node(sess, kind, name, strlen(name), n);
+
+  while (i < n) {
+    nn = va_arg(ap, struct node *);
+    TRACE(sess, TRACE_NODES, 2, "#   arg[%d]: %p\n#            (%.*s ...)\n",
+          i, (void *)nn, nn->name_len, nn->name);
+    nd->elems[i++] = nn;
+    take_slots(nd, nn);
+  }
+
+  if (kind == NK_ident) {
+    nd->ident = intern(&sess->names, nd->elems[0]->name, nd->elems[0]->name_len);
+  } else if (kind == NK_ExprLit) {
+    nd->lit = nd->elems[0];
+  }
+  return nd;
+}
+
+struct node *mk_node(struct session *sess, int kind, int n, ...) {
+  va_list ap;
+  va_start(ap, n);
+  struct node *nd = vmk_node(sess, kind, n, ap);
+  va_end(ap);
+  return nd;
+}
+
+// Text inside a mapped source stays put for the whole check, so the
+// atom can point at it; anything else (flex's own buffer, grammar
+// literals) is copied into the arena.
+struct node *mk_atom(struct session *sess, char *name) {
+  size_t len = strlen(name);
+  if (name >= sess->src && name + len <= sess->src + sess->src_len) {
+    return new_node(sess, NK_atom, name, len, 0);
+  }
+  return new_node(sess, NK_atom, arena_strndup(&sess->ast_arena, name, len), len, 0);
+}
+
+struct node *mk_none(struct session *sess) {
+  if (sess->check_only) {
+    if (!sess->none) {
+      sess->none = mk_atom(sess, "<none>");
+    }
+    return sess->none;
+  }
+  return mk_atom(sess, "<none>");
+}
+
+/* With check_only set, the parts of the tree the semantic pass never
+   looks into (attributes, doc comments, macro token trees) are built
+   as shared placeholder atoms. All such a subtree could pass up to
+   the nodes that are checked is its ident slot, so there is one
+   placeholder per ident. Placeholders, like the shared <none>, have no
+   span; no diagnostic is ever reported on one. Both are atoms, which
+   ext_node() copies rather than extends. */
+static struct node *placeholder(struct session *sess, char const *ident) {
+  struct node *&nd = sess->placeholders[ident];
+  if (!nd) {
+    nd = new_node(sess, NK_atom, "<skipped>", 9, 0);
+    nd->ident = ident;
+    nd->start = nd->end = 0;
+  }
+  return nd;
+}
+
+static char const *first_ident(char const *ident, int n, va_list ap) {
+  for (int i = 0; i < n && !ident; ++i) {
+    ident = va_arg(ap, struct node *)->ident;
+  }
+  return ident;
+}
+
+// mk_node() for a node the semantic pass never enters.
+struct node *mk_skip(struct session *sess, int kind, int n, ...) {
+  va_list ap;
+  va_start(ap, n);
+  struct node *nd = sess->check_only ? placeholder(sess, first_ident(NULL, n, ap))
+                                     : vmk_node(sess, kind, n, ap);
+  va_end(ap);
+  return nd;
+}
+
+// mk_atom() for text the semantic pass never reads.
+struct node *mk_token(struct session *sess, char *text) {
+  return sess->check_only ? placeholder(sess, NULL) : mk_atom(sess, text);
+}
+
+// Attach the scanner's decoded value to a LitInteger node; like yytext
+// it describes the token just shifted.
+struct node *with_int_lit(struct session *sess, struct node *nd) {
+  nd->int_lit = sess->lex.int_lit;
+  return nd;
+}
+
+// The arena cannot give memory back, so a list that outgrows its node
+// is moved to one with twice the capacity; the old copy stays dead
+// until the arena is freed.
+static struct node *vext_node(struct session *sess, struct node *nd, int n, va_list ap) {
+  int i = 0, c = nd->n_elems + n;
+  struct node *nn;
+
+  TRACE(sess, TRACE_NODES, 2, "# Extending %d-ary node by %d nodes: %.*s = %p",
+        nd->n_elems, c, nd->name_len, nd->name, (void *)nd);
+
+  // A node without room, like any atom, is always copied. Rules such
+  // as struct_expr_fields extend a mk_none() result, which with
+  // check_only is the shared <none>, and a placeholder may reach
+  // ext_node() too; neither must change in place.
+  if (c > nd->n_cap || nd->n_cap == 0) {
+    sess->stats.ext_reallocs++;
+    // A list built from one element skips the sizes 2 and 3, which
+    // most lists outgrow anyway.
+    int cap = nd->n_cap < 2 ? 4 : 2 * nd->n_cap;
+    while (cap < c) {
+      cap *= 2;
+    }
+    nn = alloc_node(sess, cap);
+    nn->kind = nd->kind;
+    nn->name = nd->name;
+    nn->name_len = nd->name_len;
+    nn->ident = nd->ident;
+    nn->lit = nd->lit;
+    nn->int_lit = nd->int_lit;
+    nn->n_elems = nd->n_elems;
+    nn->start = nd->start;
+    memcpy(nn->elems, nd->elems, nd->n_elems * sizeof(struct node *));
+    nd = nn;
+  }
+
+  TRACE(sess, TRACE_NODES, 2, " ==> %p\n", (void *)nd);
+  nd->end = sess->rule_span.end;
+
+  while (i < n) {
+    nn = va_arg(ap, struct node *);
+    TRACE(sess, TRACE_NODES, 2, "#   arg[%d]: %p\n#            (%.*s ...)\n",
+          i, (void *)nn, nn->name_len, nn->name);
+    nd->elems[nd->n_elems++] = nn;
+    take_slots(nd, nn);
+    ++i;
+  }
+  return nd;
+}
+
+struct node *ext_node(struct session *sess, struct node *nd, int n, ...) {
+  va_list ap;
+  va_start(ap, n);
+  nd = vext_node(sess, nd, n, ap);
+  va_end(ap);
+  return nd;
+}
+
+// ext_node() for a list built by mk_skip().
+struct node *ext_skip(struct session *sess, struct node *nd, int n, ...) {
+  va_list ap;
+  va_start(ap, n);
+  nd = sess->check_only ? placeholder(sess, first_ident(nd->ident, n, ap))
+                        : vext_node(sess, nd, n, ap);
+  va_end(ap);
+  return nd;
+}
+
+// Remember where an item's text is, for check_incremental(). Nested
+// items are recorded too and skipped when the crate is split.
+void note_item(struct session *sess, struct node *nd, struct src_span span) {
+  if (sess->scan_base) {
+    sess->item_spans.emplace_back();
+    sess->item_spans.back().node = nd;
+    sess->item_spans.back().span = span;
+  }
+}
+
+// Scopes live in one pool per session and are released together by
+// free_scopes(), which keeps them for the next crate. Bodies checked
+// on different threads may push nested scopes at the same time.
+struct sym_table *push_scope(struct session *sess, struct sym_table *parent) {
+  std::lock_guard<std::mutex> hold(sess->scope_lock);
+  if (sess->scopes_used == sess->scope_pool.size()) {
+    sess->scope_pool.emplace_back();
+  }
+  struct sym_table *table = &sess->scope_pool[sess->scopes_used++];
+  table->parent = parent;
+  table->slots.clear();
+  table->count = 0;
+  table->log = NULL;
+  return table;
+}
+
+// Scopes and slot arrays past these sizes are given back rather than
+// kept.
+#define SCOPE_KEEP 4096
+#define SCOPE_KEEP_SLOTS 1024
+
+void free_scopes(struct session *sess) {
+  if (sess->scope_pool.size() > SCOPE_KEEP) {
+    sess->scope_pool.resize(SCOPE_KEEP);
+  }
+  for (auto &t : sess->scope_pool) {
+    if (t.slots.capacity() > SCOPE_KEEP_SLOTS) {
+      vector<struct sym_entry>().swap(t.slots);
+    }
+  }
+  sess->scopes_used = 0;
+}
+
+static inline unsigned hash_name(char const *name) {
+  return (unsigned)(((uintptr_t)name >> 3) * 2654435761u);
+}
+
+static struct sym_entry *find_slot(struct sym_table *table, char const *name) {
+  unsigned mask = table->slots.size() - 1;
+  unsigned h = hash_name(name) & mask;
+  while (table->slots[h].name && table->slots[h].name != name) {
+    h = (h + 1) & mask;
+  }
+  return &table->slots[h];
+}
+
+struct sym_entry *find_symbol(struct sym_table *table, char const *name) {
+  if (table->count == 0) {
+    return NULL;
+  }
+  struct sym_entry *e = find_slot(table, name);
+  return e->name ? e : NULL;
+}
+
+static void grow_table(struct sym_table *table) {
+  // A scope reused from the pool keeps its slot array.
+  if (table->slots.empty()) {
+    table->slots.resize(8);
+    return;
+  }
+  vector<struct sym_entry> old;
+  old.swap(table->slots);
+  table->slots.resize(old.empty() ? 8 : old.size() * 2);
+  for (auto &e : old) {
+    if (e.name) {
+      struct sym_entry *slot = find_slot(table, e.name);
+      slot->name = e.name;
+      slot->scope = e.scope;
+      slot->seq = e.seq;
+      slot->type = e.type;
+    }
+  }
+}
+
+bool insert_symbol(struct sym_table *table, char const *name, int type, struct sym_table *child){
+  if (2 * (table->count + 1) > table->slots.size()) {
+    grow_table(table);
+  }
+  struct sym_entry *e = find_slot(table, name);
+  if (e->name) {
+    return false;
+  }
+  e->name = name;
+  e->scope = child;
+  e->type = type;
+  e->seq = table->count++;
+  if (table->log) {
+    table->log->push_back(name);
+  }
+  return true;
+}
+
+// One walk of the checker. Walks write only their own errors and flag,
+// so the bodies of global functions can be checked on several threads
+// and merged afterwards in source order.
+struct fn_body;
+
+// What build_sym_table() passes down the tree: the scope a node is
+// checked in and the one its entries point at.
+struct sym_walk {
+  struct sym_table *table;
+  struct sym_table *scope;
+};
+
+struct check_ctx {
+  struct session *sess = NULL;
+  // At most the session's max_errors; any more are only counted.
+  std::vector<struct diag> errors;
+  size_t dropped = 0;
+  struct diag scratch;
+  int flag = 1;
+  // Symbol lookups made and parent scopes searched.
+  size_t lookups = 0;
+  size_t scope_hops = 0;
+  // Global entries numbered limit and up are hidden: a body walked on
+  // its own must not see functions declared after it.
+  unsigned limit = UINT_MAX;
+  // When set, bodies of global functions are queued here instead of
+  // being walked.
+  std::vector<struct fn_body> *bodies = NULL;
+  // Walk stacks, kept to save allocations.
+  std::vector<struct walk_frame<struct sym_walk> > sym_stack;
+  std::vector<struct walk_frame<struct walk_none> > expr_stack;
+};
+
+struct fn_body {
+  struct node *fn;
+  struct sym_table *scope;
+  // Where the body's errors go among those of the walk that found it.
+  size_t err_pos;
+  struct check_ctx cx;
+};
+
+static void defer_body(struct check_ctx *cx, struct node *fn, struct sym_table *scope) {
+  cx->bodies->emplace_back();
+  struct fn_body &b = cx->bodies->back();
+  b.fn = fn;
+  b.scope = scope;
+  b.err_pos = cx->errors.size();
+  b.cx.sess = cx->sess;
+  b.cx.limit = scope->parent->count;
+}
+
+int build_sym_table(struct check_ctx *cx, struct sym_table *table, struct node *n, struct sym_table *scope);
+
+// Record an error of the given code at node at; the caller adds its
+// arguments. A walk that already holds max_errors errors only counts
+// it: whatever it finds later comes after those in any merged order.
+static struct diag *report(struct check_ctx *cx, int code, struct node *at) {
+  unsigned max = cx->sess->max_errors;
+  struct diag *d = &cx->scratch;
+  if (max && cx->errors.size() >= max) {
+    cx->dropped++;
+  } else {
+    cx->errors.emplace_back();
+    d = &cx->errors.back();
+  }
+  d->code = code;
+  d->n_args = 0;
+  d->start = at->start;
+  d->end = at->end;
+  return d;
+}
+
+static void add_arg(struct diag *d, char const *str, int len) {
+  d->args[d->n_args].str = str;
+  d->args[d->n_args].len = len;
+  d->n_args++;
+}
+
+static void add_arg(struct diag *d, char const *str) {
+  add_arg(d, str, strlen(str));
+}
+
+int lookup_table(struct check_ctx *cx, struct sym_table *table, char const *name, struct node *at){
+  cx->lookups++;
+  while(table && *name){
+    struct sym_entry *e = find_symbol(table, name);
+    if(e && (table->parent || e->seq < cx->limit)){
+      return e->type;
+    }
+    //Static scoping
+    table = table->parent;
+    cx->scope_hops += table != NULL;
+  }
+  TRACE(cx->sess, TRACE_SYMTAB, 2, "# symtab: %s not found\n", name);
+  add_arg(report(cx, D_IDENT_NOT_FOUND, at), name);
+  return TY_NONE;
+}
+
+
+// Largest value each integer type can hold; 0 for the 128-bit types,
+// which every decoded literal fits.
+static unsigned long long const int_type_max[INT_SUFFIX_COUNT] = {
+  0,
+  0x7f, 0x7fff, 0x7fffffff, 0x7fffffffffffffffULL, 0, 0x7fffffffffffffffULL,
+  0xff, 0xffff, 0xffffffff, ~0ULL, 0, ~0ULL
+};
+
+static int int_suffix_of(int type) {
+  switch (type) {
+  case TY_I8: return INT_SUFFIX_I8;
+  case TY_I16: return INT_SUFFIX_I16;
+  case TY_I32: return INT_SUFFIX_I32;
+  case TY_I64: return INT_SUFFIX_I64;
+  case TY_U8: return INT_SUFFIX_U8;
+  case TY_U16: return INT_SUFFIX_U16;
+  case TY_U32: return INT_SUFFIX_U32;
+  case TY_U64: return INT_SUFFIX_U64;
+  default: return INT_SUFFIX_NONE;
+  }
+}
+
+// Integer literals carry the value the scanner decoded. Report one that
+// does not fit its type: the suffix if it has one, else the declared
+// type decl (TY_NONE when there is none).
+static void check_int_lit(struct check_ctx *cx, struct node *expr, int decl) {
+  struct node *lit = expr->lit;
+  if (!lit || lit->kind != NK_LitInteger) {
+    return;
+  }
+  int type = lit->int_lit.suffix ? lit->int_lit.suffix : int_suffix_of(decl);
+  unsigned long long max = int_type_max[type];
+  if (lit->int_lit.overflow || (max && lit->int_lit.value > max)) {
+    struct node *atom = lit->elems[0];
+    struct diag *d = report(cx, D_INT_RANGE, atom);
+    add_arg(d, atom->name, atom->name_len);
+    add_arg(d, int_suffix_names[lit->int_lit.suffix]);
+    add_arg(d, type ? int_suffix_names[type] : "u64");
+  }
+}
+
+// Collect the types of the operands of root, descending into nested
+// binary operations. Returns 0 at the first operand without a type.
+int  expr_bin_type_check(struct check_ctx *cx, struct sym_table *table, struct node *root, vector<int> &types){
+  auto enter = [&](struct node *n, struct walk_none const &, struct walk_none &) -> int {
+    if (n == root) {
+      return 1;
+    }
+    switch(n->kind){
+    case NK_ExprBinary:
+      return 1;
+
+    case NK_ExprPath:
+    {
+      int type = lookup_table(cx, table, ident_of(n), n);
+      if(type == TY_NONE){
+        return -1;
+      }
+      types.push_back(type);
+      return 0;
+    }
+    case NK_ExprLit:
+    {
+      check_int_lit(cx, n, TY_NONE);
+      int type = type_of_lit(n->lit);
+      if(type == TY_NONE){
+        return -1;
+      }
+      types.push_back(type);
+      return 0;
+    }
+    }
+    return 0;
+  };
+  return walk(cx->expr_stack, root, walk_none(), enter,
+              [](struct node *, struct walk_none const &) {}) == 0;
+}
+
+int expr_flow_type_check(struct check_ctx *cx, struct sym_table *table, struct node *n, vector<int> &types){
+  int flag=1;
+  if(n->elems[1]->kind == NK_ExprBinary){
+    
+      int ret = expr_bin_type_check(cx, table, n->elems[1],types);
+      if(!ret){
+        flag=0;
+        report(cx, D_FLOW_TYPES, n->elems[1]);
+      }
+      else if(ret==1)
+      {
+        for(int i=0;i<types.size()-1;i++){
+          if(type_class(types[i])!=type_class(types[i+1])){
+            flag=0;
+            report(cx, D_FLOW_TYPES, n->elems[1]);
+          }
+        }
+      }
+    }
+
+    return flag;
+}
+// The checks of a single node, in the scope given by inner. Returns 0
+// when its children are not to be walked; a new function scope is
+// handed to them through inner.
+static int check_node(struct check_ctx *cx, struct node *n, struct sym_walk &inner){
+  struct sym_table *table = inner.table, *scope = inner.scope;
+  struct sym_table *new_scope=NULL;
+  
+  bool status;
+  switch(n->kind){
+  case NK_ItemFn:
+  {
+    new_scope= push_scope(cx->sess, table);
+    status=insert_symbol(table, n->elems[0]->ident,TY_FUNC,new_scope);
+    TRACE(cx->sess, TRACE_SYMTAB, 2, "# symtab %p: fn %s, scope %p\n",
+          (void *)table, n->elems[0]->ident, (void *)new_scope);
+    if (cx->bodies && !table->parent) {
+      defer_body(cx, n, new_scope);
+      return 0;
+    }
+    break;
+  }
+  case NK_DeclLocal:
+  {
+        int flag=1;
+        char const *name = ident_of(n->elems[0]);
+        char const *decl = ident_of(n->elems[1]);
+        int type = type_of_name(decl);
+
+        if(find_symbol(table, name))
+        {
+          flag=0;
+
+          add_arg(report(cx, D_REDECLARED, n->elems[0]), name);
+
+        }
+        
+        else if(*decl&&type==TY_NONE)
+        {
+          flag=0;
+          struct diag *d = report(cx, D_INVALID_TYPE, n->elems[1]);
+          add_arg(d, decl);
+          add_arg(d, name);
+
+        }
+
+        else
+        {
+        if(n->elems[2]->kind == NK_ExprLit){
+              check_int_lit(cx, n->elems[2], type);
+              struct node *lit = n->elems[2]->lit;
+              int infer = type_of_lit(lit);//inferred type
+              if(type==TY_NONE && lit){
+                type = infer;
+              }
+              else if(type==TY_NONE&&!lit)
+                flag=0; //dont insert into symbol table
+              else{
+                if(type_class(type)!=type_class(infer)){
+                  flag=0;
+                  add_arg(report(cx, D_DECL_MISMATCH, n), name);
+                }
+              }
+        }
+        if(n->elems[2]->kind == NK_ExprPath){
+          int infer = lookup_table(cx, table, ident_of(n->elems[2]), n->elems[2]);
+          if(type==TY_NONE && infer!=TY_NONE){
+                type = infer;
+              }
+              else if(type==TY_NONE&&infer==TY_NONE)
+                flag=0; //dont insert into symbol table
+              else{
+                if(type_class(type)!=type_class(infer)){
+                  flag=0;
+                  add_arg(report(cx, D_DECL_MISMATCH, n), name);
+                }
+              }
+        }
+        if(n->elems[2]->kind == NK_ExprBinary){
+          vector<int> types;
+          int ret = expr_bin_type_check(cx, table, n->elems[2], types);
+
+          int flag_no_right_type=1;
+          if(types.size()==0)
+          {
+            flag=0;
+            flag_no_right_type=0;
+            add_arg(report(cx, D_DECL_INVALID, n), name);
+
+            
+          }
+          
+          else
+          {
+          //fills the type vector with all the types of the 
+          // variables in the expression
+          //set flag according to ret
+            flag = flag && ret;
+            int rhs_type_flag=1;
+            if(ret==1)
+            {
+              for(int i=0;i<types.size()-1;i++){
+                if(type_class(types[i])!=type_class(types[i+1])){
+                  flag=0;
+                  rhs_type_flag=0;
+                  add_arg(report(cx, D_DECL_EXPR, n->elems[2]), name);
+                }
+              }
+            }
+
+            if (rhs_type_flag)
+            {
+              if(type==TY_NONE)
+              {
+                type = types[0];
+              }
+
+              else if (type_class(type) != type_canon(types[0]))
+              {
+              flag=0;
+              struct diag *d = report(cx, D_DECL_TYPES, n);
+              add_arg(d, name);
+              add_arg(d, type_name(type));
+              add_arg(d, type_name(types[0]));
+              }
+            
+            }
+           }
+          }
+
+        }
+        
+        if(flag)
+        {
+          
+          status=insert_symbol(table, name, type == TY_FUNC ? TY_NONE : type, scope);
+          TRACE(cx->sess, TRACE_SYMTAB, 2, "# symtab %p: let %s: %s\n",
+                (void *)table, name, type_name(type));
+        
+        }
+
+        else
+        {
+          cx->flag=0;
+        }
+    break;
+  }
+
+  case NK_ExprIf:
+  {
+    vector<int> types;
+    int flag =expr_flow_type_check(cx, table, n->elems[0],types);
+    if(flag==0)
+    {
+      cx->flag=0;
+    }
+    break;
+  }
+
+  case NK_ExprWhile:
+  {
+    vector<int> types;
+    int flag = expr_flow_type_check(cx, table, n->elems[1],types); 
+
+    if(flag==0)
+    {
+      cx->flag=0;
+    }
+    break;
+  }
+
+
+
+  case NK_ExprAssign:
+  {
+    int flag = 1;
+    char const *name = ident_of(n->elems[0]);
+    int status = lookup_table(cx, table, name, n->elems[0]);
+    if(status==TY_NONE)
+      flag=0;
+    else
+    {
+
+    if(n->elems[1]->kind == NK_ExprLit)
+      {
+        check_int_lit(cx, n->elems[1], TY_NONE);
+        int type = type_of_lit(n->elems[1]->lit);
+
+        if(type_canon(status)!=type && flag)
+        {
+          flag=0;
+          struct diag *d = report(cx, D_ASSIGN_LIT, n);
+          add_arg(d, name);
+          add_arg(d, type_name(status));
+          add_arg(d, type_name(type));
+
+        }
+
+      }
+    if(n->elems[1]->kind == NK_ExprPath){
+      int type = lookup_table(cx, table, ident_of(n->elems[1]->elems[0]), n->elems[1]);
+      if(type==TY_NONE)
+        flag=0;
+    }
+    if(n->elems[1]->kind == NK_ExprBinary){
+      vector<int> types;
+      int ret = expr_bin_type_check(cx, table, n->elems[1],types);
+      if(!ret){
+        flag=0;
+        add_arg(report(cx, D_ASSIGN_BINARY, n->elems[1]), name);
+      }
+      else if(ret==1)
+      {
+        int rhs_type_flag=1; //rhs types are assumed to be valid
+        for(int i=0;i<types.size()-1;i++){
+          if(type_class(types[i])!=type_class(types[i+1])){
+            flag=0;
+            rhs_type_flag=0;
+            add_arg(report(cx, D_ASSIGN_EXPR, n->elems[1]), name);
+          }
+        }
+
+        if (rhs_type_flag&&!(type_canon(status)==type_canon(types[0])))
+        {
+          flag=0;
+          struct diag *d = report(cx, D_ASSIGN_TYPES, n);
+          add_arg(d, name);
+          add_arg(d, type_name(status));
+          add_arg(d, type_name(types[0]));
+
+
+        }
+
+
+      }
+    }
+  }
+    if(flag){
+      
+      insert_symbol(table, name, status == TY_FUNC ? TY_NONE : status, scope);
+      TRACE(cx->sess, TRACE_SYMTAB, 2, "# symtab %p: assign %s: %s\n",
+            (void *)table, name, type_name(status));
+    }
+
+    else
+    {
+     
+      cx->flag=0;
+    }
+    break;
+  }
+  }
+  if(new_scope){
+    inner.table = new_scope;
+    inner.scope = new_scope;
+  }
+  return 1;
+}
+
+int build_sym_table(struct check_ctx *cx, struct sym_table *table, struct node *n, struct sym_table *scope){
+  struct sym_walk at = {table, scope};
+  walk(cx->sym_stack, n, at,
+       [cx](struct node *m, struct sym_walk const &, struct sym_walk &inner) {
+         return check_node(cx, m, inner);
+       },
+       [](struct node *, struct sym_walk const &) {});
+  return cx->flag;
+}
+
+static void check_body(struct fn_body *b) {
+  for (int i = 0; i < b->fn->n_elems; ++i) {
+    build_sym_table(&b->cx, b->scope, b->fn->elems[i], b->scope);
+  }
+}
+
+struct work_queue {
+  std::mutex lock;
+  std::deque<size_t> items;
+};
+
+// Next body for worker self: its own queue from the front, else one
+// stolen from the back of another's.
+static bool next_body(std::vector<work_queue> &queues, size_t self, size_t *item) {
+  for (size_t i = 0; i < queues.size(); ++i) {
+    work_queue &q = queues[(self + i) % queues.size()];
+    std::lock_guard<std::mutex> hold(q.lock);
+    if (!q.items.empty()) {
+      if (i == 0) {
+        *item = q.items.front();
+        q.items.pop_front();
+      } else {
+        *item = q.items.back();
+        q.items.pop_back();
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+static void check_bodies(struct session *sess, std::vector<struct fn_body> &bodies) {
+  size_t n = bodies.size();
+  size_t threads = sess->threads > 1 ? sess->threads : 1;
+  if (threads > n) {
+    threads = n;
+  }
+  if (threads <= 1) {
+    for (auto &b : bodies) {
+      check_body(&b);
+    }
+    return;
+  }
+  // Each worker starts on a contiguous run of bodies.
+  std::vector<work_queue> queues(threads);
+  for (size_t w = 0; w < threads; ++w) {
+    for (size_t i = w * n / threads; i < (w + 1) * n / threads; ++i) {
+      queues[w].items.push_back(i);
+    }
+  }
+  auto work = [&](size_t self) {
+    size_t i;
+    while (next_body(queues, self, &i)) {
+      check_body(&bodies[i]);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t w = 1; w < threads; ++w) {
+    workers.emplace_back(work, w);
+  }
+  work(0);
+  for (auto &t : workers) {
+    t.join();
+  }
+}
+
+// Keep the errors [d, end) of one walk, moved by shift bytes, as long
+// as the session holds fewer than max_errors.
+static void keep_errors(struct session *sess, struct diag const *d, struct diag const *end,
+                        size_t shift) {
+  for (; d != end; ++d) {
+    if (sess->max_errors && sess->semantic_errors.size() >= sess->max_errors) {
+      sess->errors_dropped += end - d;
+      return;
+    }
+    sess->semantic_errors.push_back(*d);
+    sess->semantic_errors.back().start += shift;
+    sess->semantic_errors.back().end += shift;
+  }
+}
+
+// Check the crate rooted at n: one pass over everything but the bodies
+// of global functions, which also fills the global scope, then the
+// bodies, possibly in parallel. Their errors are spliced back where a
+// single walk would have reported them.
+static int check_crate(struct session *sess, struct node *n) {
+  std::vector<struct fn_body> bodies;
+  struct check_ctx top;
+  top.sess = sess;
+  top.bodies = &bodies;
+  build_sym_table(&top, sess->global_sym_table, n, sess->global_sym_table);
+  check_bodies(sess, bodies);
+
+  struct diag const *errors = top.errors.data();
+  size_t next = 0;
+  sess->semantic_errors.clear();
+  sess->errors_dropped = top.dropped;
+  sess->global_flag = top.flag;
+  sess->stats.lookups += top.lookups;
+  sess->stats.scope_hops += top.scope_hops;
+  for (auto &b : bodies) {
+    sess->stats.lookups += b.cx.lookups;
+    sess->stats.scope_hops += b.cx.scope_hops;
+    keep_errors(sess, errors + next, errors + b.err_pos, 0);
+    keep_errors(sess, b.cx.errors.data(), b.cx.errors.data() + b.cx.errors.size(), 0);
+    sess->errors_dropped += b.cx.dropped;
+    sess->global_flag = sess->global_flag && b.cx.flag;
+    next = b.err_pos;
+  }
+  keep_errors(sess, errors + next, errors + top.errors.size(), 0);
+  return sess->global_flag;
+}
+
+static bool entry_name_less(struct sym_entry const *a, struct sym_entry const *b) {
+  return strcmp(a->name, b->name) < 0;
+}
+
+// A table being printed, with where its listing has got to.
+struct table_frame {
+  struct sym_table *table;
+  vector<struct sym_entry *> entries;
+  size_t next;
+  int depth;
+};
+
+static struct table_frame table_frame_at(struct sym_table *table, int depth) {
+  struct table_frame f{table, {}, 0, depth};
+  // Print in name order so the dump does not depend on hash layout.
+  for(auto &e : table->slots){
+    if(e.name){
+      f.entries.push_back(&e);
+    }
+  }
+  sort(f.entries.begin(), f.entries.end(), entry_name_less);
+  return f;
+}
+
+/* In text, one line per symbol with nested scopes below their owner.
+   As S-expressions and JSON, a symbol is
+       (name type symbol...)
+       {"name":"name","type":"type","symbols":[symbol...]}
+   with the nested symbols only for one that owns a scope, and the
+   table is (symbols symbol...) or {"symbols":[symbol...]}. */
+static void open_symbols(struct emitter *e, struct sym_entry const *s, int nested) {
+  char const *type = type_name(s->type);
+  emit_sep(e);
+  if (e->format == DUMP_SEXPR) {
+    emit_char(e, '(');
+    emit_atom(e, s->name, strlen(s->name));
+    emit_char(e, ' ');
+    emit_atom(e, type, strlen(type));
+    if (!nested) {
+      emit_char(e, ')');
+    }
+  } else {
+    emit_put(e, "{\"name\":", 8);
+    emit_json_string(e, s->name, strlen(s->name));
+    emit_put(e, ",\"type\":", 8);
+    emit_json_string(e, type, strlen(type));
+    emit_str(e, nested ? ",\"symbols\":[" : "}");
+  }
+  e->sep = !nested || e->format == DUMP_SEXPR;
+}
+
+static void close_symbols(struct emitter *e) {
+  emit_str(e, e->format == DUMP_SEXPR ? ")" : "]}");
+  e->sep = 1;
+}
+
+void print_symbol_table(struct session *sess, struct sym_table *table, int depth){
+  struct emitter e;
+  emit_init(&e, sess->out, sess->dump_format);
+  if (e.format == DUMP_SEXPR) {
+    emit_str(&e, "(symbols");
+    e.sep = 1;
+  } else if (e.format == DUMP_JSON) {
+    emit_str(&e, "{\"symbols\":[");
+  }
+  vector<struct table_frame> stack;
+  stack.push_back(table_frame_at(table, depth));
+  while(!stack.empty()){
+    struct table_frame &f = stack.back();
+    if(f.next == f.entries.size()){
+      stack.pop_back();
+      if (e.format != DUMP_TEXT) {
+        close_symbols(&e);
+      }
+      continue;
+    }
+    struct sym_entry *s = f.entries[f.next++];
+    int nested = s->scope != f.table;
+    if (e.format == DUMP_TEXT) {
+      // Nested scopes have only ever been indented with -v.
+      if (sess->verbose) {
+        emit_indent(&e, f.depth);
+      }
+      emit_printf(&e, "%15s%15p%15s\n", s->name, (void *)s->scope, type_name(s->type));
+    } else {
+      open_symbols(&e, s, nested);
+    }
+    if(nested){
+      stack.push_back(table_frame_at(s->scope, f.depth+indent_step));
+    }
+  }
+  emit_end(&e);
+  emit_done(&e);
+}
+
+void print_node(struct session *sess, struct node *n, int depth) {
+  struct emitter e;
+  vector<struct walk_frame<int> > stack;
+  auto enter = [&e](struct node *m, int const &depth, int &inner) {
+    if (m->n_elems == 0) {
+      emit_leaf(&e, depth, m->name, m->name_len);
+      return 0;
+    }
+    emit_open(&e, depth, m->name, m->name_len);
+    inner = depth + indent_step;
+    return 1;
+  };
+  auto leave = [&e](struct node *m, int const &depth) {
+    if (m->n_elems != 0) {
+      emit_close(&e, depth);
+    }
+  };
+  emit_init(&e, sess->out, sess->dump_format);
+  walk(stack, n, depth, enter, leave);
+  emit_end(&e);
+  emit_done(&e);
+}
+
+// Only the operators, names and literals of the tree. In text the
+// expressions of a crate follow one another; as S-expressions and JSON
+// they are the elements of an "ast" node.
+void print_ast(struct session *sess, struct node *n, int depth){
+  if (!sess->verbose || !sess->out) {
+    return;
+  }
+  struct emitter e;
+  vector<struct walk_frame<int> > stack;
+  auto enter = [&e](struct node *m, int const &depth, int &inner) {
+    switch (m->kind) {
+    case NK_ident:
+      emit_leaf(&e, depth, m->elems[0]->name, m->elems[0]->name_len);
+      return 0;
+
+    case NK_ExprLit:
+      emit_leaf(&e, depth, m->elems[0]->elems[0]->name, m->elems[0]->elems[0]->name_len);
+      return 0;
+
+    case NK_ExprBinary:
+      emit_open(&e, depth, m->elems[0]->name, m->elems[0]->name_len);
+      inner = depth + indent_step;
+      return 1;
+    }
+    return 1;
+  };
+  auto leave = [&e](struct node *m, int const &depth) {
+    if (m->kind == NK_ExprBinary) {
+      emit_close(&e, depth);
+    }
+  };
+  emit_init(&e, sess->out, sess->dump_format);
+  if (e.format != DUMP_TEXT) {
+    emit_open(&e, depth, "ast", 3);
+  }
+  walk(stack, n, depth, enter, leave);
+  if (e.format != DUMP_TEXT) {
+    emit_close(&e, depth);
+  }
+  emit_end(&e);
+  emit_done(&e);
+}
+
+void print_semantic_errors(struct session *sess){
+  string msg;
+  for(auto &i: sess->semantic_errors){
+    msg.clear();
+    diag_message(&i, msg);
+    msg += '\n';
+    fputs(msg.c_str(), sess->out);
+  }
+  if (sess->errors_dropped) {
+    fprintf(sess->out, "... and %zu more\n", sess->errors_dropped);
+  }
+}
+
+struct session *session_new() {
+  struct session *sess = new session();
+  sess->scanner = NULL;
+  sess->push_parser = NULL;
+  sess->threads = 1;
+  sess->parse_only = 0;
+  sess->check_only = 0;
+  sess->stats.enabled = 0;
+  sess->trace.mask = 0;
+  sess->trace.level = 0;
+  sess->max_errors = 0;
+  sess->diag_format = DIAG_REPORT;
+  sess->dump_format = DUMP_TEXT;
+  sess->diag_file = NULL;
+  sess->out = stdout;
+  sess->err = stderr;
+  session_reset(sess);
+  return sess;
+}
+
+void session_free(struct session *sess) {
+  session_reset(sess);
+  arena_free(&sess->ast_arena);
+  intern_free(&sess->names);
+  trace_ring(&sess->trace, 0);
+  yylex_destroy(sess->scanner);
+  delete sess;
+}
+
+// Bring every piece of per-crate state back to how a fresh session
+// starts. Interned names are kept; they are only a cache. The scanner
+// is rebuilt since a failed parse can leave it mid-token or inside a
+// start condition.
+static void reset_scanner(struct session *sess) {
+  if (sess->scanner) {
+    yylex_destroy(sess->scanner);
+  }
+  memset(sess->pushback, '\0', PUSHBACK_LEN);
+  memset(&sess->lex, 0, sizeof(sess->lex));
+  yylex_init_extra(&sess->lex, &sess->scanner);
+}
+
+static void reset_stats(struct session *sess) {
+  int enabled = sess->stats.enabled;
+  memset(&sess->stats, 0, sizeof(sess->stats));
+  sess->stats.enabled = enabled;
+}
+
+void session_reset(struct session *sess) {
+  reset_scanner(sess);
+  arena_reset(&sess->ast_arena);
+  free_scopes(sess);
+  sess->ast_root = NULL;
+  sess->none = NULL;
+  sess->placeholders.clear();
+  sess->n_nodes = 0;
+  sess->parse_errors.clear();
+  sess->semantic_errors.clear();
+  sess->errors_dropped = 0;
+  reset_stats(sess);
+  sess->global_sym_table = NULL;
+  sess->global_flag = 1;
+  sess->src = NULL;
+  sess->src_len = 0;
+  sess->scan_base = NULL;
+  sess->scan_offset = 0;
+  sess->incr_valid = 0;
+  sess->incr_src.clear();
+  sess->incr_items.clear();
+  sess->incr_attrs = NULL;
+  sess->incr_arena_live = 0;
+  sess->item_spans.clear();
+  push_parser_free(sess);
+  sess->stream.clear();
+  sess->stream_pos = 0;
+  sess->stream_tried = 0;
+  sess->stream_seen = 0;
+  sess->stream_cut = 0;
+  sess->stream_state = lex_state(sess->scanner);
+  sess->stream_depth = 0;
+  sess->stream_line = 1;
+  sess->stream_closer.clear();
+  sess->stream_status = -1;
+  sess->stream_loc = src_span();
+}
+
+static void print_report(struct session *sess, int status) {
+  print_symbol_table(sess, sess->global_sym_table,0);
+  fprintf(sess->out, "No. of semantic errors : %ld\n",sess->semantic_errors.size() + sess->errors_dropped);
+
+  print_semantic_errors(sess);
+
+  if(status==1)
+  {
+    fputs("Abstract Syntax Tree\n", sess->out);
+    print_ast(sess, sess->ast_root,0);
+  }
+}
+
+static void print_parse(struct session *sess, int ret) {
+  TRACE(sess, TRACE_PARSER, 1, "--- PARSE COMPLETE: ret:%d, n_nodes:%d ---\n", ret, sess->n_nodes);
+  TRACE(sess, TRACE_PARSER, 1, "--- ARENA: %zu allocations, %zu bytes used, %zu bytes in %zu blocks ---\n",
+        sess->ast_arena.n_allocs, sess->ast_arena.bytes_used,
+        sess->ast_arena.bytes_reserved, sess->ast_arena.n_blocks);
+  if (sess->ast_root && sess->verbose && sess->out) {
+    print_node(sess, sess->ast_root, 0);
+  }
+}
+
+// The classic report goes to out unless diagnostics were asked for in
+// one of the diag_writer formats.
+static inline bool reporting(struct session *sess) {
+  return sess->out && sess->diag_format == DIAG_REPORT;
+}
+
+// Write the parse and semantic errors of the last check; text is the
+// source their offsets point into, or NULL when it was read as a
+// stream.
+static void write_diagnostics(struct session *sess, char const *text, size_t len) {
+  if (!sess->out || sess->diag_format == DIAG_REPORT) {
+    return;
+  }
+  struct diag_writer w;
+  diag_writer_init(&w, sess->out, sess->diag_format, sess->diag_file, text, len);
+  diag_begin(&w, sess->parse_errors.size() + sess->semantic_errors.size());
+  for (auto &d : sess->parse_errors) {
+    diag_write(&w, &d);
+  }
+  for (auto &d : sess->semantic_errors) {
+    diag_write(&w, &d);
+  }
+}
+
+// Everything after the parse: the symbol table, the report and the
+// diagnostics. All but the check itself is timed as printing, the -v
+// tree dump included.
+static int finish_check(struct session *sess, int ret, char const *text, size_t len) {
+  unsigned long long t0, start = now_ns();
+  sess->stats.check_ns = 0;
+  print_parse(sess, ret);
+  if(ret==0 && !sess->parse_only)
+  {
+  if (reporting(sess)) {
+    fprintf(sess->out, "Building symbol table with root %p\n",sess->global_sym_table);
+  }
+  t0 = now_ns();
+  int status = check_crate(sess, sess->ast_root);
+  sess->stats.check_ns = now_ns() - t0;
+  if (reporting(sess)) {
+    print_report(sess, status);
+  }
+  }
+  write_diagnostics(sess, text, len);
+  sess->stats.print_ns = now_ns() - start - sess->stats.check_ns;
+  return ret;
+}
+
+static int run_check(struct session *sess, char const *text, size_t len) {
+  int ret = 0;
+  /* rsdebug = 1; */
+  sess->global_sym_table = push_scope(sess, NULL);
+  unsigned long long t0 = now_ns();
+  ret = rsparse(sess);
+  sess->stats.parse_ns = now_ns() - t0 - sess->stats.lex_ns;
+  return finish_check(sess, ret, text, len);
+}
+
+/* Push mode. The pieces are appended to sess->stream, and whenever one
+   brings a newline the text up to the last newline is scanned from a
+   copy of its own and each token handed to the push parser as soon as
+   it is lexed, so actions still see it in yytext. A token never ends
+   in a newline, so every token before the cut is whole; only one the
+   scanner ran out of input inside (a string, raw string or doc
+   comment that goes on past the cut) is left for the next scan, which
+   starts over at its first byte. That scan waits until the text that
+   could end it has arrived. A plain block comment builds no token, so
+   the next scan goes on inside it instead. An error the scanner finds
+   before the cut is handed on like any token. */
+static int push_with_pushback(struct session *sess, int token) {
+  int ret = push_token(sess, token, &sess->stream_loc);
+  while (ret < 0 && (token = pop_pushback(sess))) {
+    ret = push_token(sess, token, &sess->stream_loc);
+  }
+  return ret;
+}
+
+static void stream_scan(struct session *sess, size_t end, int final) {
+  unsigned long long t0 = now_ns();
+  size_t len = end - sess->stream_pos;
+  sess->scan_buf.assign(sess->stream.data() + sess->stream_pos, sess->stream.data() + end);
+  sess->scan_buf.resize(len + 2, '\0');
+  struct yy_buffer_state *b = yy_scan_buffer(sess->scan_buf.data(), len + 2, sess->scanner);
+  sess->scan_base = sess->scan_buf.data();
+  sess->scan_offset = sess->stream_pos;
+  lex_resume(sess->scanner, sess->stream_state, sess->stream_depth);
+  yyset_lineno(sess->stream_line, sess->scanner);
+  size_t from = 0;
+  while (sess->stream_status < 0) {
+    int state = lex_state(sess->scanner);
+    int line = yyget_lineno(sess->scanner);
+    int token = scan_token(sess, &sess->stream_loc);
+    if (!final && (token == 0 || (token < 0 && lex_at_end(sess->scanner)))) {
+      // Out of input: wait for the rest of an unfinished token, or
+      // for the next piece.
+      char closer[256];
+      int depth = token == 0 ? lex_depth(sess->scanner) : 0;
+      if ((token == 0 && lex_idle(sess->scanner)) || depth) {
+        from = len;
+        state = lex_state(sess->scanner);
+        line = yyget_lineno(sess->scanner);
+      }
+      sess->stream_closer.assign(closer, lex_closer(sess->scanner, closer, sizeof(closer)));
+      sess->stream_pos += from;
+      sess->stream_state = state;
+      sess->stream_depth = depth;
+      sess->stream_line = line;
+      break;
+    }
+    sess->stream_status = push_with_pushback(sess, token);
+    from = yyget_text(sess->scanner) + yyget_leng(sess->scanner) - sess->scan_base;
+  }
+  sess->stream_tried = sess->stream_seen = end;
+  yy_delete_buffer(b, sess->scanner);
+  sess->scan_base = NULL;
+  sess->stats.parse_ns += now_ns() - t0;
+}
+
+void check_begin(struct session *sess) {
+  session_reset(sess);
+  sess->global_sym_table = push_scope(sess, NULL);
+}
+
+int check_feed(struct session *sess, char const *buf, size_t len) {
+  if (sess->stream_status >= 0) {
+    return sess->stream_status;
+  }
+  size_t old = sess->stream.size();
+  sess->stream.append(buf, len);
+  char const *text = sess->stream.data();
+  char const *nl = (char const *)memrchr(text + old, '\n', len);
+  if (nl) {
+    sess->stream_cut = nl + 1 - text;
+  }
+  if (sess->stream_cut <= sess->stream_tried) {
+    return sess->stream_status;
+  }
+  if (!sess->stream_closer.empty()) {
+    // Look only at what has not been looked at, and at the end of
+    // that, where a closer may have begun.
+    size_t k = sess->stream_closer.size();
+    size_t from = sess->stream_seen - min(k - 1, sess->stream_seen - sess->stream_pos);
+    sess->stream_seen = sess->stream.size();
+    if (!memmem(text + from, sess->stream.size() - from, sess->stream_closer.data(), k)) {
+      return sess->stream_status;
+    }
+  }
+  stream_scan(sess, sess->stream_cut, 0);
+  return sess->stream_status;
+}
+
+int check_finish(struct session *sess) {
+  if (sess->stream_status < 0) {
+    stream_scan(sess, sess->stream.size(), 1);
+  }
+  sess->stats.parse_ns -= sess->stats.lex_ns;
+  return finish_check(sess, sess->stream_status, sess->stream.data(), sess->stream.size());
+}
+
+// Read in as it comes, so that a parse error in a pipe is reported
+// before the writer is done.
+int check_stream(struct session *sess, FILE *in) {
+  char buf[65536];
+  check_begin(sess);
+  for (;;) {
+    ssize_t n = read(fileno(in), buf, sizeof(buf));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      session_reset(sess);
+      return -1;
+    }
+    if (n == 0 || check_feed(sess, buf, n) >= 0) {
+      break;
+    }
+  }
+  return check_finish(sess);
+}
+
+// buf is copied so that it can be scanned in place like a mapped file,
+// which gives every token its offset.
+int check_buffer(struct session *sess, char const *buf, size_t len) {
+  session_reset(sess);
+  sess->scan_buf.assign(buf, buf + len);
+  sess->scan_buf.resize(len + 2, '\0');
+  struct yy_buffer_state *b = yy_scan_buffer(sess->scan_buf.data(), len + 2, sess->scanner);
+  sess->scan_base = sess->scan_buf.data();
+  int ret = run_check(sess, buf, len);
+  yy_delete_buffer(b, sess->scanner);
+  return ret;
+}
+
+int check_source(struct session *sess, char *buf, size_t len) {
+  session_reset(sess);
+  struct yy_buffer_state *b = yy_scan_buffer(buf, len + 2, sess->scanner);
+  sess->src = buf;
+  sess->src_len = len;
+  sess->scan_base = buf;
+  int ret = run_check(sess, buf, len);
+  yy_delete_buffer(b, sess->scanner);
+  return ret;
+}
+
+void write_stats(struct session *sess, FILE *out, char const *file, int json) {
+  struct check_stats const &st = sess->stats;
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  if (json) {
+    fputs("{\"file\":", out);
+    json_string(out, file, strlen(file));
+    fprintf(out, ",\"lex_ms\":%.3f,\"parse_ms\":%.3f,\"check_ms\":%.3f,\"print_ms\":%.3f,"
+            "\"nodes\":%d,\"ext_node_reallocs\":%zu,\"arena_bytes\":%zu,\"arena_reserved\":%zu,"
+            "\"lookups\":%zu,\"scope_hops\":%zu,\"parse_errors\":%zu,\"semantic_errors\":%zu,"
+            "\"peak_rss_kb\":%ld}\n",
+            st.lex_ns / 1e6, st.parse_ns / 1e6, st.check_ns / 1e6, st.print_ns / 1e6,
+            sess->n_nodes, st.ext_reallocs, sess->ast_arena.bytes_used, sess->ast_arena.bytes_reserved,
+            st.lookups, st.scope_hops, sess->parse_errors.size(),
+            sess->semantic_errors.size() + sess->errors_dropped, ru.ru_maxrss);
+    return;
+  }
+  fprintf(out, "--- stats: %s ---\n", file);
+  fprintf(out, "lex               %10.3f ms\n", st.lex_ns / 1e6);
+  fprintf(out, "parse             %10.3f ms\n", st.parse_ns / 1e6);
+  fprintf(out, "build_sym_table   %10.3f ms\n", st.check_ns / 1e6);
+  fprintf(out, "print             %10.3f ms\n", st.print_ns / 1e6);
+  fprintf(out, "nodes             %10d\n", sess->n_nodes);
+  fprintf(out, "ext_node reallocs %10zu\n", st.ext_reallocs);
+  fprintf(out, "arena bytes       %10zu (%zu reserved)\n",
+          sess->ast_arena.bytes_used, sess->ast_arena.bytes_reserved);
+  fprintf(out, "lookups           %10zu\n", st.lookups);
+  fprintf(out, "scope hops        %10zu\n", st.scope_hops);
+  fprintf(out, "errors            %10zu (%zu parse)\n",
+          sess->parse_errors.size() + sess->semantic_errors.size() + sess->errors_dropped,
+          sess->parse_errors.size());
+  fprintf(out, "peak RSS          %10ld KB\n", ru.ru_maxrss);
+}
+
+static unsigned long long const fp_basis = 14695981039346656037ull;
+
+static unsigned long long fp_bytes(unsigned long long h, void const *p, size_t len) {
+  unsigned char const *s = (unsigned char const *)p;
+  for (size_t i = 0; i < len; ++i) {
+    h = (h ^ s[i]) * 1099511628211ull;
+  }
+  return h;
+}
+
+static int count_nodes(struct node *n) {
+  vector<struct walk_frame<struct walk_none> > stack;
+  int c = 0;
+  walk(stack, n, walk_none(),
+       [&c](struct node *, struct walk_none const &, struct walk_none &) { ++c; return 1; },
+       [](struct node *, struct walk_none const &) {});
+  return c;
+}
+
+// Parse text as a crate of its own, as if it started at offset and on
+// line of the whole source. Atoms are copied to the arena, so the tree
+// outlives the scan buffer. *idle tells whether the scanner ended
+// outside any comment or string.
+static int parse_text(struct session *sess, char const *text, size_t len,
+                      size_t offset, int line, int *idle) {
+  reset_scanner(sess);
+  yyset_lineno(line, sess->scanner);
+  sess->scan_buf.assign(text, text + len);
+  sess->scan_buf.resize(len + 2, '\0');
+  sess->src = NULL;
+  sess->src_len = 0;
+  sess->scan_base = sess->scan_buf.data();
+  sess->scan_offset = offset;
+  sess->item_spans.clear();
+  sess->ast_root = NULL;
+  struct yy_buffer_state *b = yy_scan_buffer(sess->scan_buf.data(), len + 2, sess->scanner);
+  int ret = rsparse(sess);
+  *idle = lex_idle(sess->scanner);
+  yy_delete_buffer(b, sess->scanner);
+  sess->scan_base = NULL;
+  return ret;
+}
+
+// Split the crate just parsed into its top-level items, using the
+// spans the parser recorded. text is the whole source.
+static void split_items(struct session *sess, char const *text, vector<struct top_item> &out) {
+  struct node *root = sess->ast_root;
+  struct node *list = root->elems[root->n_elems - 1];
+  if (list->kind != NK_Items) {
+    return;
+  }
+  size_t j = 0;
+  for (int i = 0; i < list->n_elems; ++i) {
+    while (sess->item_spans[j].node != list->elems[i]) {
+      ++j;
+    }
+    struct top_item &it = sess->item_spans[j];
+    it.fp = fp_bytes(fp_basis, text + it.span.start, it.span.end - it.span.start);
+    it.n_nodes = count_nodes(it.node);
+    it.node_base = it.span.start;
+    it.checked = 0;
+    out.push_back(std::move(it));
+  }
+}
+
+// Rebuild the crate node around the kept items, in the shape the
+// grammar gives it.
+static struct node *join_items(struct session *sess) {
+  struct node *list;
+  size_t n = sess->incr_items.size();
+  if (n == 0) {
+    list = mk_none(sess);
+  } else {
+    list = new_node(sess, NK_Items, node_kind_names[NK_Items], strlen(node_kind_names[NK_Items]), n);
+    for (size_t i = 0; i < n; ++i) {
+      list->elems[i] = sess->incr_items[i].node;
+      take_slots(list, list->elems[i]);
+    }
+  }
+  if (sess->incr_attrs) {
+    return mk_node(sess, NK_crate, 2, sess->incr_attrs, list);
+  }
+  return mk_node(sess, NK_crate, 1, list);
+}
+
+// Check the items in order. An item whose text and global scope are
+// what they were last time replays its entries and errors instead of
+// being walked again; build_sym_table() over the whole crate visits
+// the same items in the same order, so the results are identical.
+static int check_items(struct session *sess) {
+  struct sym_table *global = sess->global_sym_table;
+  vector<char const *> log;
+  unsigned long long env = fp_basis;
+  global->slots.clear();
+  global->count = 0;
+  sess->semantic_errors.clear();
+  sess->errors_dropped = 0;
+  sess->global_flag = 1;
+  for (auto &it : sess->incr_items) {
+    if (!it.checked || it.env != env) {
+      struct check_ctx cx;
+      cx.sess = sess;
+      log.clear();
+      global->log = &log;
+      build_sym_table(&cx, global, it.node, global);
+      global->log = NULL;
+      sess->stats.lookups += cx.lookups;
+      sess->stats.scope_hops += cx.scope_hops;
+      it.checked = 1;
+      it.env = env;
+      it.flag = cx.flag;
+      it.errors.swap(cx.errors);
+      it.dropped = cx.dropped;
+      for (auto &d : it.errors) {
+        d.start -= it.node_base;
+        d.end -= it.node_base;
+      }
+      it.globals.clear();
+      for (auto name : log) {
+        it.globals.push_back(*find_symbol(global, name));
+      }
+    } else {
+      for (auto &e : it.globals) {
+        insert_symbol(global, e.name, e.type, e.scope);
+      }
+    }
+    keep_errors(sess, it.errors.data(), it.errors.data() + it.errors.size(), it.span.start);
+    sess->errors_dropped += it.dropped;
+    sess->global_flag = sess->global_flag && it.flag;
+    for (auto &e : it.globals) {
+      env = fp_bytes(env, &e.name, sizeof(e.name));
+      env = fp_bytes(env, &e.type, sizeof(e.type));
+    }
+  }
+  return sess->global_flag;
+}
+
+// n_nodes counts the nodes of the current tree rather than those
+// allocated, since most of them were built by earlier calls. It differs
+// from a full check's count; see result::n_nodes.
+static void finish_incremental(struct session *sess, char const *buf, size_t len) {
+  sess->n_nodes = 2;
+  if (sess->incr_attrs) {
+    sess->n_nodes += count_nodes(sess->incr_attrs);
+  }
+  for (auto &it : sess->incr_items) {
+    sess->n_nodes += it.n_nodes;
+  }
+  unsigned long long t0, start = now_ns();
+  print_parse(sess, 0);
+  if (reporting(sess)) {
+    fprintf(sess->out, "Building symbol table with root %p\n",sess->global_sym_table);
+  }
+  t0 = now_ns();
+  int status = check_items(sess);
+  sess->stats.check_ns = now_ns() - t0;
+  if (reporting(sess)) {
+    print_report(sess, status);
+  }
+  write_diagnostics(sess, buf, len);
+  sess->stats.print_ns = now_ns() - start - sess->stats.check_ns;
+}
+
+// Re-parse only the stretch of buf between the last unchanged item
+// before the edit and the first unchanged item after it. Gives up,
+// leaving the report to a full check, unless that stretch parses on
+// its own into whole items and ends outside any comment or string:
+// only then is the full parse guaranteed to split the same way.
+static int update_items(struct session *sess, char const *buf, size_t len) {
+  string const &old = sess->incr_src;
+  vector<struct top_item> &items = sess->incr_items;
+  size_t n = items.size(), old_len = old.size();
+  size_t p = 0, s = 0;
+  while (p < old_len && p < len && old[p] == buf[p]) {
+    ++p;
+  }
+  while (s < old_len - p && s < len - p && old[old_len - 1 - s] == buf[len - 1 - s]) {
+    ++s;
+  }
+
+  // Items touching the edit are [lo, hi]; the range may be empty.
+  size_t lo = 0, hi = n;
+  while (lo < n && items[lo].span.end < p) {
+    ++lo;
+  }
+  while (hi > lo && items[hi - 1].span.start > old_len - s) {
+    --hi;
+  }
+  size_t start = lo > 0 ? items[lo - 1].span.end : 0;
+  size_t old_end = hi < n ? items[hi].span.start : old_len;
+  size_t end = old_end + len - old_len;
+
+  int line = 1;
+  for (char const *q = buf; (q = (char const *)memchr(q, '\n', buf + start - q)); ++q) {
+    ++line;
+  }
+  int verbose = sess->verbose, idle = 0;
+  unsigned trace = sess->trace.mask;
+  FILE *err = sess->err;
+  sess->verbose = 0;
+  sess->trace.mask = 0;
+  sess->err = NULL;
+  int ret = parse_text(sess, buf + start, end - start, start, line, &idle);
+  sess->verbose = verbose;
+  sess->trace.mask = trace;
+  sess->err = err;
+  if (ret || !idle || !sess->ast_root) {
+    return 0;
+  }
+  struct node *attrs = sess->ast_root->n_elems == 2 ? sess->ast_root->elems[0] : NULL;
+  if (attrs && start > 0) {
+    return 0;
+  }
+
+  vector<struct top_item> fresh, merged;
+  split_items(sess, buf, fresh);
+  merged.reserve(lo + fresh.size() + n - hi);
+  for (size_t i = 0; i < lo; ++i) {
+    merged.push_back(std::move(items[i]));
+  }
+  // A re-parsed item whose text is unchanged keeps its old node and
+  // check results.
+  size_t k = lo;
+  for (auto &it : fresh) {
+    size_t m = k;
+    size_t it_len = it.span.end - it.span.start;
+    while (m < hi && !(items[m].fp == it.fp &&
+                       items[m].span.end - items[m].span.start == it_len &&
+                       old.compare(items[m].span.start, it_len, buf + it.span.start, it_len) == 0)) {
+      ++m;
+    }
+    if (m < hi) {
+      items[m].span = it.span;
+      merged.push_back(std::move(items[m]));
+      k = m + 1;
+    } else {
+      merged.push_back(std::move(it));
+    }
+  }
+  for (size_t i = hi; i < n; ++i) {
+    items[i].span.start += len - old_len;
+    items[i].span.end += len - old_len;
+    merged.push_back(std::move(items[i]));
+  }
+  items.swap(merged);
+  if (start == 0) {
+    sess->incr_attrs = attrs;
+  }
+  sess->incr_src.assign(buf, len);
+  sess->ast_root = join_items(sess);
+  finish_incremental(sess, buf, len);
+  return 1;
+}
+
+int check_incremental(struct session *sess, char const *buf, size_t len) {
+  // Replaced items stay in the arena until the next full check; start
+  // over once they outweigh the live tree.
+  if (sess->incr_valid &&
+      sess->ast_arena.bytes_used <= 4 * sess->incr_arena_live + ARENA_BLOCK_SIZE) {
+    sess->parse_errors.clear();
+    reset_stats(sess);
+    if (update_items(sess, buf, len)) {
+      return 0;
+    }
+  }
+  session_reset(sess);
+  sess->global_sym_table = push_scope(sess, NULL);
+  int idle;
+  int ret = parse_text(sess, buf, len, 0, 1, &idle);
+  if (ret) {
+    print_parse(sess, ret);
+    write_diagnostics(sess, buf, len);
+    return ret;
+  }
+  split_items(sess, buf, sess->incr_items);
+  sess->incr_attrs = sess->ast_root->n_elems == 2 ? sess->ast_root->elems[0] : NULL;
+  sess->incr_src.assign(buf, len);
+  sess->incr_arena_live = sess->ast_arena.bytes_used;
+  sess->incr_valid = 1;
+  finish_incremental(sess, buf, len);
+  return 0;
+}
+
+void rserror(struct src_span *lloc, struct session *sess, char const *s) {
+  struct diag d;
+  d.code = D_SYNTAX;
+  d.n_args = 1;
+  d.start = lloc->start;
+  d.end = lloc->end;
+  d.args[0].str = arena_strdup(&sess->ast_arena, s);
+  d.args[0].len = strlen(s);
+  sess->parse_errors.push_back(d);
+  if (sess->err && sess->diag_format == DIAG_REPORT) {
+    fprintf (sess->err, "%s\n", s);
+  }
+}
+
+namespace semanticrs {
+
+Session::Session() : sess(session_new()) {
+}
+
+Session::~Session() {
+  session_free(sess);
+}
+
+static void add_diagnostic(result &res, struct diag_writer *w, diagnostic_kind kind,
+                           struct diag const &d) {
+  res.diagnostics.emplace_back();
+  diagnostic &out = res.diagnostics.back();
+  out.kind = kind;
+  diag_message(&d, out.message);
+  out.code = diag_code_name(d.code);
+  diag_locate(w, d.start, &out.line, &out.column);
+}
+
+static result collect(struct session *sess, int status, char const *buf, size_t len) {
+  result res;
+  res.parse_status = status;
+  res.n_nodes = sess->n_nodes;
+  res.errors_dropped = sess->errors_dropped;
+  struct diag_writer w;
+  diag_writer_init(&w, NULL, DIAG_TEXT, NULL, buf, len);
+  for (auto &e : sess->parse_errors) {
+    add_diagnostic(res, &w, DIAG_PARSE, e);
+  }
+  for (auto &e : sess->semantic_errors) {
+    add_diagnostic(res, &w, DIAG_SEMANTIC, e);
+  }
+  return res;
+}
+
+static void set_options(struct session *sess, options const &opts) {
+  sess->verbose = opts.verbose;
+  sess->trace.mask = opts.verbose ? TRACE_PARSER | TRACE_NODES : 0;
+  sess->trace.level = 2;
+  sess->threads = opts.threads;
+  sess->max_errors = opts.max_errors;
+  sess->dump_format = opts.dump;
+  sess->out = opts.report;
+  sess->err = NULL;
+}
+
+result Session::check(char const *buf, size_t len, options const &opts) {
+  set_options(sess, opts);
+  sess->check_only = opts.check_only;
+  return collect(sess, check_buffer(sess, buf, len), buf, len);
+}
+
+result Session::recheck(char const *buf, size_t len, options const &opts) {
+  set_options(sess, opts);
+  if (opts.check_only != sess->check_only) {
+    sess->incr_valid = 0;
+    sess->check_only = opts.check_only;
+  }
+  return collect(sess, check_incremental(sess, buf, len), buf, len);
+}
+
+void Session::begin(options const &opts) {
+  set_options(sess, opts);
+  sess->check_only = opts.check_only;
+  check_begin(sess);
+}
+
+bool Session::feed(char const *buf, size_t len) {
+  return check_feed(sess, buf, len) < 0;
+}
+
+result Session::finish() {
+  int status = check_finish(sess);
+  return collect(sess, status, sess->stream.data(), sess->stream.size());
+}
+
+result check(char const *buf, size_t len, options const &opts) {
+  Session s;
+  return s.check(buf, len, opts);
+}
+
+}
@@ -0,0 +1,152 @@
+#include <cstring>
+#include <algorithm>
+
+#include "diag.h"
+
+using namespace std;
+
+// Message templates; %0 to %2 stand for the arguments.
+static char const *const diag_templates[D_COUNT] = {
+  "%0",
+  "Identifier %0 not found",
+  "Integer literal %0%1 out of range for %2",
+  "Redeclaration of %0",
+  "Invalid type %0 in declaration of %1",
+  "Declaration of %0 invalid, types mismatch",
+  "Invalid declaration of %0",
+  "Expression involving declaration of %0 is invalid",
+  "Type mis match in declaration of %0 LHS TYPE %1 RHS TYPE %2",
+  "Invalid types for binary operation in the flow control predicate",
+  "Type mis match in assignement of %0 LHS TYPE %1 RHS TYPE %2",
+  "Invalid types for binary operation during assignment of %0",
+  "Expression involving assignment of %0 is invalid",
+  "Type mismatch in assignement of %0 LHS TYPE %1 RHS TYPE %2"
+};
+
+static char const *const diag_names[D_COUNT] = {
+  "E0001", "E0002", "E0003", "E0004", "E0005", "E0006", "E0007",
+  "E0008", "E0009", "E0010", "E0011", "E0012", "E0013", "E0014"
+};
+
+char const *diag_code_name(int code) {
+  return diag_names[code];
+}
+
+void diag_message(struct diag const *d, string &out) {
+  for (char const *p = diag_templates[d->code]; *p; ++p) {
+    if (p[0] == '%' && p[1] >= '0' && p[1] < '0' + d->n_args) {
+      struct diag_arg const &a = d->args[*++p - '0'];
+      out.append(a.str, a.len);
+    } else {
+      out += *p;
+    }
+  }
+}
+
+void diag_writer_init(struct diag_writer *w, FILE *out, int format, char const *file,
+                      char const *src, size_t src_len) {
+  w->out = out;
+  w->format = format;
+  w->file = file ? file : "<stdin>";
+  w->src = src;
+  w->src_len = src_len;
+  w->lines.clear();
+}
+
+void diag_locate(struct diag_writer *w, unsigned offset, int *line, int *col) {
+  if (offset == DIAG_NO_POS || !w->src || offset > w->src_len) {
+    *line = *col = 0;
+    return;
+  }
+  if (w->lines.empty()) {
+    w->lines.push_back(0);
+    for (char const *p = w->src, *end = w->src + w->src_len;
+         (p = (char const *)memchr(p, '\n', end - p)); ++p) {
+      w->lines.push_back(p - w->src + 1);
+    }
+  }
+  size_t i = upper_bound(w->lines.begin(), w->lines.end(), offset) - w->lines.begin();
+  *line = i;
+  *col = offset - w->lines[i - 1] + 1;
+}
+
+void json_string(FILE *out, char const *s, size_t len) {
+  fputc('"', out);
+  for (size_t i = 0; i < len; ++i) {
+    unsigned char c = s[i];
+    if (c == '"' || c == '\\') {
+      fputc('\\', out);
+      fputc(c, out);
+    } else if (c < 0x20) {
+      fprintf(out, "\\u%04x", c);
+    } else {
+      fputc(c, out);
+    }
+  }
+  fputc('"', out);
+}
+
+void diag_begin(struct diag_writer *w, size_t n) {
+  if (w->format == DIAG_BINARY) {
+    struct diag_stream_header h;
+    memcpy(h.magic, DIAG_STREAM_MAGIC, 4);
+    h.version = DIAG_STREAM_VERSION;
+    h.n_diags = n;
+    h.file_len = strlen(w->file);
+    fwrite(&h, sizeof(h), 1, w->out);
+    fwrite(w->file, 1, h.file_len, w->out);
+  }
+}
+
+void diag_write(struct diag_writer *w, struct diag const *d) {
+  int line, col, end_line, end_col;
+  diag_locate(w, d->start, &line, &col);
+  diag_locate(w, d->end, &end_line, &end_col);
+  string msg;
+  switch (w->format) {
+  case DIAG_TEXT:
+    diag_message(d, msg);
+    if (line) {
+      fprintf(w->out, "%s:%d:%d: error[%s]: %s\n", w->file, line, col,
+              diag_code_name(d->code), msg.c_str());
+    } else {
+      fprintf(w->out, "%s: error[%s]: %s\n", w->file, diag_code_name(d->code), msg.c_str());
+    }
+    break;
+
+  case DIAG_JSON:
+    diag_message(d, msg);
+    fputs("{\"file\":", w->out);
+    json_string(w->out, w->file, strlen(w->file));
+    fprintf(w->out, ",\"line\":%d,\"column\":%d,\"end_line\":%d,\"end_column\":%d,\"code\":\"%s\",\"message\":",
+            line, col, end_line, end_col, diag_code_name(d->code));
+    json_string(w->out, msg.data(), msg.size());
+    fputs(",\"args\":[", w->out);
+    for (int i = 0; i < d->n_args; ++i) {
+      if (i) {
+        fputc(',', w->out);
+      }
+      json_string(w->out, d->args[i].str, d->args[i].len);
+    }
+    fputs("]}\n", w->out);
+    break;
+
+  case DIAG_BINARY:
+  {
+    struct diag_record r;
+    r.code = d->code;
+    r.n_args = d->n_args;
+    r.line = line;
+    r.col = col;
+    r.end_line = end_line;
+    r.end_col = end_col;
+    fwrite(&r, sizeof(r), 1, w->out);
+    for (int i = 0; i < d->n_args; ++i) {
+      uint32_t len = d->args[i].len;
+      fwrite(&len, sizeof(len), 1, w->out);
+      fwrite(d->args[i].str, 1, len, w->out);
+    }
+    break;
+  }
+  }
+}
@@ -0,0 +1,108 @@
+#ifndef DIAG_H
+#define DIAG_H
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* A diagnostic is kept as a code, a source span and up to three
+   arguments; the message text is only put together when it is written
+   out, by diag_message() or a diag_writer. */
+enum diag_code {
+  D_SYNTAX,
+  D_IDENT_NOT_FOUND,
+  D_INT_RANGE,
+  D_REDECLARED,
+  D_INVALID_TYPE,
+  D_DECL_MISMATCH,
+  D_DECL_INVALID,
+  D_DECL_EXPR,
+  D_DECL_TYPES,
+  D_FLOW_TYPES,
+  D_ASSIGN_LIT,
+  D_ASSIGN_BINARY,
+  D_ASSIGN_EXPR,
+  D_ASSIGN_TYPES,
+  D_COUNT
+};
+
+#define DIAG_MAX_ARGS 3
+// Span of a diagnostic whose source position is not known, such as one
+// from a crate read as a stream.
+#define DIAG_NO_POS 0xffffffffu
+
+// Arguments point at interned names, atoms or static strings, so they
+// stay valid until the session is reset.
+struct diag_arg {
+  char const *str;
+  int len;
+};
+
+struct diag {
+  unsigned short code;
+  unsigned short n_args;
+  // Byte offsets into the source.
+  unsigned start;
+  unsigned end;
+  struct diag_arg args[DIAG_MAX_ARGS];
+};
+
+// "E0002" and so on.
+char const *diag_code_name(int code);
+// Append the message text, without a trailing newline.
+void diag_message(struct diag const *d, std::string &out);
+
+enum diag_format {
+  DIAG_REPORT,  // the classic report; no diag_writer involved
+  DIAG_TEXT,    // file:line:col: error[E0002]: message
+  DIAG_JSON,    // one JSON object per line
+  DIAG_BINARY   // see diag_record below
+};
+
+/* Writes diagnostics of one source. Line and column numbers are found
+   from the offsets through a table of line starts, built the first
+   time a position is needed. */
+struct diag_writer {
+  FILE *out;
+  int format;
+  char const *file;
+  char const *src;
+  size_t src_len;
+  std::vector<unsigned> lines;
+};
+
+void diag_writer_init(struct diag_writer *w, FILE *out, int format, char const *file,
+                      char const *src, size_t src_len);
+// 1-based line and column of offset; 0 and 0 when it is not known.
+void diag_locate(struct diag_writer *w, unsigned offset, int *line, int *col);
+// Start the output for n diagnostics; only DIAG_BINARY writes anything.
+void diag_begin(struct diag_writer *w, size_t n);
+void diag_write(struct diag_writer *w, struct diag const *d);
+// Write s as a quoted JSON string.
+void json_string(FILE *out, char const *s, size_t len);
+
+/* DIAG_BINARY output is one section per source: a diag_stream_header,
+   the file name (file_len bytes), then per diagnostic a diag_record
+   followed by n_args arguments, each a uint32_t length and that many
+   bytes. All fields are in host byte order. */
+#define DIAG_STREAM_MAGIC "RSDG"
+#define DIAG_STREAM_VERSION 1
+
+struct diag_stream_header {
+  char magic[4];
+  uint32_t version;
+  uint32_t n_diags;
+  uint32_t file_len;
+};
+
+struct diag_record {
+  uint16_t code;
+  uint16_t n_args;
+  uint32_t line;
+  uint32_t col;
+  uint32_t end_line;
+  uint32_t end_col;
+};
+
+#endif
@@ -0,0 +1,213 @@
+#include <cstdarg>
+#include <cstdlib>
+
+#include "emit.h"
+
+#define EMIT_BLOCK 65536
+// Indentation is copied from a fixed run of it; this many columns, a
+// multiple of indent_step, are written in one go.
+#define INDENT_RUN 256
+
+void emit_init(struct emitter *e, FILE *out, int format) {
+  e->out = out;
+  e->format = format;
+  e->buf = (char *)malloc(EMIT_BLOCK);
+  e->len = 0;
+  e->cap = EMIT_BLOCK;
+  e->sep = 0;
+}
+
+void emit_flush(struct emitter *e) {
+  if (e->len) {
+    fwrite(e->buf, 1, e->len, e->out);
+    e->len = 0;
+  }
+}
+
+void emit_done(struct emitter *e) {
+  emit_flush(e);
+  free(e->buf);
+  e->buf = NULL;
+  e->cap = 0;
+}
+
+void emit_write(struct emitter *e, char const *s, size_t len) {
+  emit_flush(e);
+  if (len >= e->cap) {
+    fwrite(s, 1, len, e->out);
+    return;
+  }
+  memcpy(e->buf, s, len);
+  e->len = len;
+}
+
+void emit_printf(struct emitter *e, char const *format, ...) {
+  va_list args;
+  va_start(args, format);
+  size_t room = e->cap - e->len;
+  int n = vsnprintf(e->buf + e->len, room, format, args);
+  va_end(args);
+  if (n < 0) {
+    return;
+  }
+  if ((size_t)n < room) {
+    e->len += n;
+    return;
+  }
+  emit_flush(e);
+  va_start(args, format);
+  if ((size_t)n < e->cap) {
+    e->len = vsnprintf(e->buf, e->cap, format, args);
+  } else {
+    vfprintf(e->out, format, args);
+  }
+  va_end(args);
+}
+
+/* A column at distance k from the text has a bar when k is a multiple
+   of indent_step, so the last depth columns of a run of INDENT_RUN are
+   the indentation for any depth up to INDENT_RUN. */
+static char const *indent_run() {
+  static struct run {
+    char cols[INDENT_RUN];
+    run() {
+      for (int i = 0; i < INDENT_RUN; ++i) {
+        cols[i] = (INDENT_RUN - i) % indent_step == 0 ? '|' : ' ';
+      }
+    }
+  } const r;
+  return r.cols;
+}
+
+void emit_indent(struct emitter *e, int depth) {
+  char const *run = indent_run();
+  int part = depth % INDENT_RUN;
+  emit_put(e, run + INDENT_RUN - part, part);
+  for (depth -= part; depth; depth -= INDENT_RUN) {
+    emit_put(e, run, INDENT_RUN);
+  }
+}
+
+void emit_json_string(struct emitter *e, char const *s, size_t len) {
+  emit_char(e, '"');
+  size_t plain = 0;
+  for (size_t i = 0; i < len; ++i) {
+    unsigned char c = s[i];
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+    emit_put(e, s + plain, i - plain);
+    plain = i + 1;
+    switch (c) {
+    case '"': emit_put(e, "\\\"", 2); break;
+    case '\\': emit_put(e, "\\\\", 2); break;
+    case '\n': emit_put(e, "\\n", 2); break;
+    case '\t': emit_put(e, "\\t", 2); break;
+    case '\r': emit_put(e, "\\r", 2); break;
+    default: emit_printf(e, "\\u%04x", c);
+    }
+  }
+  emit_put(e, s + plain, len - plain);
+  emit_char(e, '"');
+}
+
+static int bare_atom_char(unsigned char c) {
+  return c > ' ' && c < 0x7f && !strchr("()\"';`,|\\#", c);
+}
+
+void emit_atom(struct emitter *e, char const *s, size_t len) {
+  size_t i = 0;
+  while (i < len && bare_atom_char(s[i])) {
+    ++i;
+  }
+  if (len && i == len) {
+    emit_put(e, s, len);
+    return;
+  }
+  emit_char(e, '"');
+  for (i = 0; i < len; ++i) {
+    switch (s[i]) {
+    case '"': emit_put(e, "\\\"", 2); break;
+    case '\\': emit_put(e, "\\\\", 2); break;
+    case '\n': emit_put(e, "\\n", 2); break;
+    case '\t': emit_put(e, "\\t", 2); break;
+    case '\r': emit_put(e, "\\r", 2); break;
+    default: emit_char(e, s[i]);
+    }
+  }
+  emit_char(e, '"');
+}
+
+void emit_sep(struct emitter *e) {
+  if (e->sep) {
+    emit_char(e, e->format == DUMP_JSON ? ',' : ' ');
+  }
+}
+
+void emit_open(struct emitter *e, int depth, char const *name, size_t len) {
+  switch (e->format) {
+  case DUMP_TEXT:
+    emit_indent(e, depth);
+    emit_char(e, '(');
+    emit_put(e, name, len);
+    emit_char(e, '\n');
+    break;
+  case DUMP_SEXPR:
+    emit_sep(e);
+    emit_char(e, '(');
+    emit_atom(e, name, len);
+    e->sep = 1;
+    break;
+  case DUMP_JSON:
+    emit_sep(e);
+    emit_put(e, "{\"node\":", 8);
+    emit_json_string(e, name, len);
+    emit_put(e, ",\"elems\":[", 10);
+    e->sep = 0;
+    break;
+  }
+}
+
+void emit_leaf(struct emitter *e, int depth, char const *name, size_t len) {
+  switch (e->format) {
+  case DUMP_TEXT:
+    emit_indent(e, depth);
+    emit_put(e, name, len);
+    emit_char(e, '\n');
+    break;
+  case DUMP_SEXPR:
+    emit_sep(e);
+    emit_atom(e, name, len);
+    e->sep = 1;
+    break;
+  case DUMP_JSON:
+    emit_sep(e);
+    emit_json_string(e, name, len);
+    e->sep = 1;
+    break;
+  }
+}
+
+void emit_close(struct emitter *e, int depth) {
+  switch (e->format) {
+  case DUMP_TEXT:
+    emit_indent(e, depth);
+    emit_put(e, ")\n", 2);
+    break;
+  case DUMP_SEXPR:
+    emit_char(e, ')');
+    e->sep = 1;
+    break;
+  case DUMP_JSON:
+    emit_put(e, "]}", 2);
+    e->sep = 1;
+    break;
+  }
+}
+
+void emit_end(struct emitter *e) {
+  if (e->format != DUMP_TEXT && e->sep) {
+    emit_char(e, '\n');
+  }
+  e->sep = 0;
+}
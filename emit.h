@@ -0,0 +1,81 @@
+#ifndef EMIT_H
+#define EMIT_H
+
+#include <cstdio>
+#include <cstring>
+
+#include "semanticrs.h"
+
+/* Buffered output for the tree and symbol table dumps. Text goes into
+   a large block that is handed to stdio only when it fills up or the
+   dump is done, so a dump costs a memcpy per line rather than a
+   formatted write per line or per indentation column. */
+struct emitter {
+  FILE *out;
+  int format;
+  char *buf;
+  size_t len;
+  size_t cap;
+  // Something was already written in the current list, so the next
+  // element needs a separator (S-expressions and JSON only).
+  int sep;
+};
+
+// The formats are listed in the public header, as options::dump.
+using semanticrs::dump_format;
+using semanticrs::DUMP_TEXT;
+using semanticrs::DUMP_SEXPR;
+using semanticrs::DUMP_JSON;
+
+// Columns per level of the text format.
+int const indent_step = 4;
+
+void emit_init(struct emitter *e, FILE *out, int format);
+// Write out what is buffered and free the block.
+void emit_done(struct emitter *e);
+void emit_flush(struct emitter *e);
+void emit_write(struct emitter *e, char const *s, size_t len);
+void emit_printf(struct emitter *e, char const *format, ...)
+  __attribute__((format(printf, 2, 3)));
+// depth columns of indentation, with a bar every indent_step.
+void emit_indent(struct emitter *e, int depth);
+// s as a JSON string, or as an S-expression atom, quoted only when it
+// has to be.
+void emit_json_string(struct emitter *e, char const *s, size_t len);
+void emit_atom(struct emitter *e, char const *s, size_t len);
+// The separator due before the next element of a list, if any.
+void emit_sep(struct emitter *e);
+
+static inline void emit_put(struct emitter *e, char const *s, size_t len) {
+  if (e->cap - e->len >= len) {
+    memcpy(e->buf + e->len, s, len);
+    e->len += len;
+  } else {
+    emit_write(e, s, len);
+  }
+}
+
+static inline void emit_str(struct emitter *e, char const *s) {
+  emit_put(e, s, strlen(s));
+}
+
+static inline void emit_char(struct emitter *e, char c) {
+  if (e->len == e->cap) {
+    emit_flush(e);
+  }
+  e->buf[e->len++] = c;
+}
+
+/* Trees are written as a sequence of open, leaf and close calls; depth
+   is only used by the text format. A text tree is
+       (name
+           leaf
+       )
+   an S-expression one (name leaf) and a JSON one
+   {"node":"name","elems":["leaf"]}. emit_end() ends a tree. */
+void emit_open(struct emitter *e, int depth, char const *name, size_t len);
+void emit_leaf(struct emitter *e, int depth, char const *name, size_t len);
+void emit_close(struct emitter *e, int depth);
+void emit_end(struct emitter *e);
+
+#endif
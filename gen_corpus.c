@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Writes a synthetic crate for benchmarking. The crate checks cleanly:
+   every function declares its locals up front and then assigns and
+   tests them with expressions of matching types, so the semantic pass
+   does its full amount of work on every statement.
+
+   usage: gen_corpus [-n functions] [-d depth] [-e operands] [-l locals]
+                     [-c comment%] [-s seed] */
+
+struct shape {
+  int functions;  // number of functions
+  int depth;      // if/while nesting below each statement
+  int operands;   // operands per binary expression
+  int locals;     // locals per function, and statements per body
+  int comments;   // percentage of statements preceded by a comment
+};
+
+/* A fixed generator, so a seed gives the same crate everywhere. */
+static unsigned long long rng_state;
+
+static unsigned rng(unsigned n) {
+  rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return (unsigned)(rng_state >> 33) % n;
+}
+
+static void indent(int depth) {
+  while (depth--) {
+    fputs("    ", stdout);
+  }
+}
+
+static void comment(struct shape const *s, int depth) {
+  if ((int)rng(100) >= s->comments) {
+    return;
+  }
+  indent(depth);
+  if (rng(4) == 0) {
+    fputs("/* block comment spanning\n", stdout);
+    indent(depth);
+    fputs("   more than one line */\n", stdout);
+  } else {
+    printf("// note %u: keep the operands of this statement in range\n", rng(1000));
+  }
+}
+
+/* Locals a0.. are integers and b0.. floats; an expression only mixes
+   operands of one kind. */
+static void operand(int is_float, int locals) {
+  if (rng(3) == 0) {
+    if (is_float) {
+      printf("%u.%u", rng(100), rng(10));
+    } else {
+      printf("%u", rng(1000));
+    }
+  } else {
+    printf("%c%u", is_float ? 'b' : 'a', rng(locals));
+  }
+}
+
+static void expr(struct shape const *s, int is_float, int n) {
+  static char const ops[] = "+-*";
+  operand(is_float, s->locals);
+  for (int i = 1; i < n; ++i) {
+    printf(" %c ", ops[rng(3)]);
+    operand(is_float, s->locals);
+  }
+}
+
+static void block(struct shape const *s, int depth, int level, int n);
+
+static void statement(struct shape const *s, int depth, int level) {
+  int is_float = rng(2);
+  int kind = level < s->depth ? rng(10) : 0;
+  comment(s, depth);
+  indent(depth);
+  if (kind < 7) {
+    printf("%c%u = ", is_float ? 'b' : 'a', rng(s->locals));
+    expr(s, is_float, s->operands);
+    fputs(";\n", stdout);
+  } else {
+    fputs(kind < 9 ? "if " : "while ", stdout);
+    printf("%c%u < ", is_float ? 'b' : 'a', rng(s->locals));
+    expr(s, is_float, 1);
+    fputs(" {\n", stdout);
+    block(s, depth + 1, level + 1, 3);
+    indent(depth);
+    fputs("}\n", stdout);
+  }
+}
+
+static void block(struct shape const *s, int depth, int level, int n) {
+  for (int i = 0; i < n; ++i) {
+    statement(s, depth, level);
+  }
+}
+
+static void function(struct shape const *s, int index) {
+  printf("fn f%d() {\n", index);
+  for (int i = 0; i < s->locals; ++i) {
+    comment(s, 1);
+    printf("    let a%d: i64 = %u;\n", i, rng(1000));
+    printf("    let b%d: f64 = %u.5;\n", i, rng(1000));
+  }
+  block(s, 1, 0, s->locals);
+  fputs("}\n\n", stdout);
+}
+
+int main(int argc, char **argv) {
+  struct shape s = { 1000, 2, 4, 8, 10 };
+  unsigned long long seed = 1;
+  for (int i = 1; i < argc; ++i) {
+    int *field = NULL;
+    if (i + 1 < argc && argv[i][0] == '-' && strlen(argv[i]) == 2) {
+      switch (argv[i][1]) {
+      case 'n': field = &s.functions; break;
+      case 'd': field = &s.depth; break;
+      case 'e': field = &s.operands; break;
+      case 'l': field = &s.locals; break;
+      case 'c': field = &s.comments; break;
+      case 's': seed = strtoull(argv[++i], NULL, 10); continue;
+      }
+    }
+    if (!field) {
+      fprintf(stderr, "usage: gen_corpus [-n functions] [-d depth] [-e operands] [-l locals]\n"
+                      "                  [-c comment%%] [-s seed]\n");
+      return 1;
+    }
+    *field = atoi(argv[++i]);
+  }
+  if (s.operands < 1 || s.locals < 1) {
+    fprintf(stderr, "gen_corpus: -e and -l must be at least 1\n");
+    return 1;
+  }
+  rng_state = seed;
+  for (int i = 0; i < s.functions; ++i) {
+    function(&s, i);
+  }
+  return 0;
+}
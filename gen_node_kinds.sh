@@ -0,0 +1,33 @@
+#!/bin/sh
+# Generates node_kinds.h from the mk_node(sess, NK_..., ...) and mk_skip()
+# calls in the grammar, so adding a node kind only takes a new action in
+# parser.y.
+#
+# usage: gen_node_kinds.sh parser.y > node_kinds.h
+
+kinds=$(grep -Eo 'mk_(node|skip)\(sess, NK_[A-Za-z0-9_]*' "$1" | sed 's/^mk_[a-z]*(sess, NK_//' | LC_ALL=C sort -u)
+
+echo "// Generated from $1 by gen_node_kinds.sh; do not edit."
+echo "#ifndef NODE_KINDS_H"
+echo "#define NODE_KINDS_H"
+echo
+echo "enum node_kind {"
+echo "  NK_atom,"
+for k in $kinds; do
+  echo "  NK_$k,"
+done
+echo "  NK_COUNT"
+echo "};"
+echo
+echo "extern char const *const node_kind_names[NK_COUNT];"
+echo
+echo "#ifdef NODE_KINDS_IMPL"
+echo "char const *const node_kind_names[NK_COUNT] = {"
+echo "  \"<atom>\","
+for k in $kinds; do
+  echo "  \"$k\","
+done
+echo "};"
+echo "#endif"
+echo
+echo "#endif"
@@ -0,0 +1,78 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include <stdio.h>
+
+/* Integer literal type suffixes, indexed into int_suffix_names. */
+enum int_suffix {
+  INT_SUFFIX_NONE,
+  INT_SUFFIX_I8, INT_SUFFIX_I16, INT_SUFFIX_I32, INT_SUFFIX_I64,
+  INT_SUFFIX_I128, INT_SUFFIX_ISIZE,
+  INT_SUFFIX_U8, INT_SUFFIX_U16, INT_SUFFIX_U32, INT_SUFFIX_U64,
+  INT_SUFFIX_U128, INT_SUFFIX_USIZE,
+  INT_SUFFIX_COUNT
+};
+
+/* An integer literal as decoded by the scanner. overflow is set when
+   the value does not fit in 64 bits; value then holds the low bits. */
+struct int_lit {
+  unsigned long long value;
+  short suffix;
+  short overflow;
+};
+
+/* Interface to the reentrant scanner generated from tokens.l. All of
+   the scanner's state hangs off a yyscan_t; lex_extra holds the bits
+   the rules themselves keep between tokens (raw string delimiters and
+   the last integer literal). */
+struct lex_extra {
+  int num_hashes;
+  int end_hashes;
+  int saw_non_hash;
+  struct int_lit int_lit;
+};
+
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void *yyscan_t;
+#endif
+
+int yylex_init_extra(struct lex_extra *extra, yyscan_t *scanner);
+int yylex_destroy(yyscan_t scanner);
+int yylex(yyscan_t scanner);
+char *yyget_text(yyscan_t scanner);
+int yyget_leng(yyscan_t scanner);
+int yyget_lineno(yyscan_t scanner);
+void yyset_lineno(int line, yyscan_t scanner);
+void yyset_in(FILE *in, yyscan_t scanner);
+struct yy_buffer_state *yy_scan_bytes(const char *bytes, int len, yyscan_t scanner);
+struct yy_buffer_state *yy_scan_buffer(char *base, size_t size, yyscan_t scanner);
+void yy_delete_buffer(struct yy_buffer_state *b, yyscan_t scanner);
+/* Nonzero when the scanner is between tokens in its initial state,
+   i.e. not inside a comment, string or literal suffix. */
+int lex_idle(yyscan_t scanner);
+/* The start condition and block comment depth to resume in with the
+   next buffer, whether the scanner ran out of input, and the text that
+   can end the token it ran out of input in. */
+int lex_state(yyscan_t scanner);
+int lex_depth(yyscan_t scanner);
+void lex_resume(yyscan_t scanner, int state, int depth);
+int lex_at_end(yyscan_t scanner);
+int lex_closer(yyscan_t scanner, char *buf, int size);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern char const *const int_suffix_names[INT_SUFFIX_COUNT];
+
+/* Decode the integer literal text[0..len) (hex, octal, binary or
+   decimal, with '_' separators and an optional type suffix) in one
+   pass. Returns the length of the literal without its suffix. */
+int decode_int(char const *text, int len, struct int_lit *lit);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
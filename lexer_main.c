@@ -1,21 +1,125 @@
 #include <stdio.h>
+#include <string.h>
+#include <errno.h>
 #include "tokens.h"
+#include "lexer.h"
+#include "source_map.h"
+#include "token_stream.h"
 
-extern int yylex();
-extern int yyget_lineno();
-extern void print_token(int);
+extern void print_token(int, char const *);
 
-int main(void) {
+#define RECORD_BLOCK 4096
+
+/* --binary output: records are collected in blocks and written with a
+   single fwrite each. */
+struct record_writer {
+  struct token_record recs[RECORD_BLOCK];
+  int n;
+  char const *pos;
+  uint32_t line;
+};
+
+static void flush_records(struct record_writer *w) {
+  fwrite(w->recs, sizeof(struct token_record), w->n, stdout);
+  w->n = 0;
+}
+
+static void put_record(struct record_writer *w, int token, char const *base,
+                       char const *text, int len) {
+  struct token_record *r;
+  // Lines are counted from the source itself, since yylineno is past
+  // the end of multi-line tokens by the time they are returned.
+  while ((w->pos = memchr(w->pos, '\n', text - w->pos))) {
+    w->pos++;
+    w->line++;
+  }
+  w->pos = text;
+  if (w->n == RECORD_BLOCK) {
+    flush_records(w);
+  }
+  r = &w->recs[w->n++];
+  r->token = token;
+  r->offset = text - base;
+  r->len = len;
+  r->line = w->line;
+}
+
+static struct record_writer writer;
+
+/* usage: lexer [--binary] [file.rs]
+   A named regular file is mapped and scanned in place; anything else,
+   stdin included, is read into memory first. */
+int main(int argc, char **argv) {
+  struct lex_extra extra = { 0 };
+  struct source_map m;
+  char const *path = NULL;
+  int binary = 0;
+  int ret = 0;
+  yyscan_t scanner;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--binary") == 0) {
+      binary = 1;
+    } else if (!path && (argv[i][0] != '-' || !argv[i][1])) {
+      path = argv[i];
+    } else {
+      fprintf(stderr, "usage: lexer [--binary] [file.rs]\n");
+      return 1;
+    }
+  }
+  if (path && strcmp(path, "-") == 0) {
+    path = NULL;
+  }
+
+  int r = path ? source_map_open(&m, path) : 1;
+  if (r > 0) {
+    FILE *in = path ? fopen(path, "r") : stdin;
+    r = in ? source_map_read(&m, in) : -1;
+    if (in && in != stdin) {
+      fclose(in);
+    }
+  }
+  if (r < 0) {
+    fprintf(stderr, "lexer: cannot read %s: %s\n", path ? path : "stdin", strerror(errno));
+    return 1;
+  }
+
+  yylex_init_extra(&extra, &scanner);
+  yy_scan_buffer(m.base, m.len + 2, scanner);
+  if (binary) {
+    struct token_stream_header h;
+    memcpy(h.magic, TOKEN_STREAM_MAGIC, 4);
+    h.version = TOKEN_STREAM_VERSION;
+    h.record_size = sizeof(struct token_record);
+    h.reserved = 0;
+    fwrite(&h, sizeof(h), 1, stdout);
+    writer.pos = m.base;
+    writer.line = 1;
+  }
   while (1) {
-    int token = yylex();
+    int token = yylex(scanner);
     if (token == 0) {
       break;
     }
     if (token < 0) {
-      printf("error on line %d\n", yyget_lineno());
+      if (binary) {
+        fprintf(stderr, "lexer: error on line %d\n", yyget_lineno(scanner));
+        ret = 1;
+      } else {
+        printf("error on line %d\n", yyget_lineno(scanner));
+      }
       break;
     }
-    print_token(token);
+    if (binary) {
+      put_record(&writer, token, m.base, yyget_text(scanner), yyget_leng(scanner));
+    } else {
+      print_token(token, yyget_text(scanner));
+    }
+  }
+  if (binary) {
+    flush_records(&writer);
   }
-  return 0;
+  yylex_destroy(scanner);
+  source_map_close(&m);
+  return ret;
 }
@@ -11,16 +11,71 @@
 %{
 #define YYERROR_VERBOSE
 #define YYSTYPE struct node *
-struct node;
-extern int yylex();
-extern void yyerror(char const *s);
-extern struct node *mk_node(char const *name, int n, ...);
-extern struct node *mk_atom(char *text);
-extern struct node *mk_none();
-extern struct node *ext_node(struct node *nd, int n, ...);
-extern void push_back(char c);
-extern char *yytext;
+#include "session.h"
+extern int rslex(YYSTYPE *lval, struct src_span *lloc, struct session *sess);
+extern void rserror(struct src_span *lloc, struct session *sess, char const *s);
+extern struct node *mk_node(struct session *sess, int kind, int n, ...);
+extern struct node *mk_atom(struct session *sess, char *text);
+extern struct node *mk_none(struct session *sess);
+extern struct node *with_int_lit(struct session *sess, struct node *nd);
+extern struct node *ext_node(struct session *sess, struct node *nd, int n, ...);
+extern struct node *mk_skip(struct session *sess, int kind, int n, ...);
+extern struct node *ext_skip(struct session *sess, struct node *nd, int n, ...);
+extern struct node *mk_token(struct session *sess, char *text);
+extern void push_back(struct session *sess, char c);
+extern void note_item(struct session *sess, struct node *nd, struct src_span span);
+extern void *grow_parse_stack(std::vector<char> &buf, void const *stack, size_t used, size_t size);
+extern void push_parser_free(struct session *sess);
+// A symbol's span runs from its first non-empty part to its end; an
+// empty one sits at the end of what precedes it. The nodes an action
+// builds take the span of its rule.
+#define YYLLOC_DEFAULT(Cur, Rhs, N) do { \
+    if (N) { \
+      int i_ = 1; \
+      while (i_ < (N) && YYRHSLOC(Rhs, i_).start == YYRHSLOC(Rhs, i_).end) { \
+        ++i_; \
+      } \
+      (Cur).start = YYRHSLOC(Rhs, i_).start; \
+      (Cur).end = YYRHSLOC(Rhs, N).end; \
+    } else { \
+      (Cur).start = (Cur).end = YYRHSLOC(Rhs, 0).end; \
+    } \
+    sess->rule_span = (Cur); \
+  } while (0)
+// The checker walks the tree without recursion, so nesting is bounded
+// only by the parser's own stack; let that grow well past the default.
+// Bison will not relocate a stack of src_span in C++, so the session
+// grows it instead.
+#define YYMAXDEPTH 1000000
+#define yyoverflow(Msg, Ss, Ss_used, Vs, Vs_used, Ls, Ls_used, Size) do { \
+    if (*(Size) >= YYMAXDEPTH) { \
+      YYNOMEM; \
+    } \
+    *(Size) = *(Size) * 2 < YYMAXDEPTH ? *(Size) * 2 : YYMAXDEPTH; \
+    *(Ss) = (yy_state_t *)grow_parse_stack(sess->parse_stacks[0], *(Ss), (Ss_used), \
+                                           *(Size) * sizeof(yy_state_t)); \
+    *(Vs) = (YYSTYPE *)grow_parse_stack(sess->parse_stacks[1], *(Vs), (Vs_used), \
+                                        *(Size) * sizeof(YYSTYPE)); \
+    *(Ls) = (YYLTYPE *)grow_parse_stack(sess->parse_stacks[2], *(Ls), (Ls_used), \
+                                        *(Size) * sizeof(YYLTYPE)); \
+  } while (0)
+// With yyoverflow defined bison leaves these out, but the push parser
+// allocates its state with them.
+#define YYMALLOC malloc
+#define YYFREE free
+// Actions read the matched text of the session's own scanner.
+#define yytext yyget_text(sess->scanner)
 %}
+%code requires {
+struct session;
+struct src_span;
+}
+%define api.pure full
+%define api.push-pull both
+%define api.location.type {struct src_span}
+%locations
+%parse-param {struct session *sess}
+%lex-param {struct session *sess}
 %debug
 
 %token SHL
@@ -217,8 +272,8 @@ extern char *yytext;
 ////////////////////////////////////////////////////////////////////////
 
 crate
-: maybe_shebang inner_attrs maybe_mod_items  { mk_node("crate", 2, $2, $3); }
-| maybe_shebang maybe_mod_items  { mk_node("crate", 1, $2); }
+: maybe_shebang inner_attrs maybe_mod_items  { sess->ast_root = mk_node(sess, NK_crate, 2, $2, $3); }
+| maybe_shebang maybe_mod_items  { sess->ast_root = mk_node(sess, NK_crate, 1, $2); }
 ;
 
 maybe_shebang
@@ -228,63 +283,63 @@ maybe_shebang
 
 maybe_inner_attrs
 : inner_attrs
-| %empty                   { $$ = mk_none(); }
+| %empty                   { $$ = mk_none(sess); }
 ;
 
 inner_attrs
-: inner_attr               { $$ = mk_node("InnerAttrs", 1, $1); }
-| inner_attrs inner_attr   { $$ = ext_node($1, 1, $2); }
+: inner_attr               { $$ = mk_skip(sess, NK_InnerAttrs, 1, $1); }
+| inner_attrs inner_attr   { $$ = ext_skip(sess, $1, 1, $2); }
 ;
 
 inner_attr
-: SHEBANG '[' meta_item ']'   { $$ = mk_node("InnerAttr", 1, $3); }
-| INNER_DOC_COMMENT           { $$ = mk_node("InnerAttr", 1, mk_node("doc-comment", 1, mk_atom(yytext))); }
+: SHEBANG '[' meta_item ']'   { $$ = mk_skip(sess, NK_InnerAttr, 1, $3); }
+| INNER_DOC_COMMENT           { $$ = mk_skip(sess, NK_InnerAttr, 1, mk_skip(sess, NK_doc_comment, 1, mk_token(sess, yytext))); }
 ;
 
 maybe_outer_attrs
 : outer_attrs
-| %empty                   { $$ = mk_none(); }
+| %empty                   { $$ = mk_none(sess); }
 ;
 
 outer_attrs
-: outer_attr               { $$ = mk_node("OuterAttrs", 1, $1); }
-| outer_attrs outer_attr   { $$ = ext_node($1, 1, $2); }
+: outer_attr               { $$ = mk_skip(sess, NK_OuterAttrs, 1, $1); }
+| outer_attrs outer_attr   { $$ = ext_skip(sess, $1, 1, $2); }
 ;
 
 outer_attr
 : '#' '[' meta_item ']'    { $$ = $3; }
-| OUTER_DOC_COMMENT        { $$ = mk_node("doc-comment", 1, mk_atom(yytext)); }
+| OUTER_DOC_COMMENT        { $$ = mk_skip(sess, NK_doc_comment, 1, mk_token(sess, yytext)); }
 ;
 
 meta_item
-: ident                      { $$ = mk_node("MetaWord", 1, $1); }
-| ident '=' lit              { $$ = mk_node("MetaNameValue", 2, $1, $3); }
-| ident '(' meta_seq ')'     { $$ = mk_node("MetaList", 2, $1, $3); }
-| ident '(' meta_seq ',' ')' { $$ = mk_node("MetaList", 2, $1, $3); }
+: ident                      { $$ = mk_skip(sess, NK_MetaWord, 1, $1); }
+| ident '=' lit              { $$ = mk_skip(sess, NK_MetaNameValue, 2, $1, $3); }
+| ident '(' meta_seq ')'     { $$ = mk_skip(sess, NK_MetaList, 2, $1, $3); }
+| ident '(' meta_seq ',' ')' { $$ = mk_skip(sess, NK_MetaList, 2, $1, $3); }
 ;
 
 meta_seq
-: %empty                   { $$ = mk_none(); }
-| meta_item                { $$ = mk_node("MetaItems", 1, $1); }
-| meta_seq ',' meta_item   { $$ = ext_node($1, 1, $3); }
+: %empty                   { $$ = mk_none(sess); }
+| meta_item                { $$ = mk_skip(sess, NK_MetaItems, 1, $1); }
+| meta_seq ',' meta_item   { $$ = ext_skip(sess, $1, 1, $3); }
 ;
 
 maybe_mod_items
 : mod_items
-| %empty             { $$ = mk_none(); }
+| %empty             { $$ = mk_none(sess); }
 ;
 
 mod_items
-: mod_item                               { $$ = mk_node("Items", 1, $1); }
-| mod_items mod_item                     { $$ = ext_node($1, 1, $2); }
+: mod_item                               { $$ = mk_node(sess, NK_Items, 1, $1); }
+| mod_items mod_item                     { $$ = ext_node(sess, $1, 1, $2); }
 ;
 
 attrs_and_vis
-: maybe_outer_attrs visibility           { $$ = mk_node("AttrsAndVis", 2, $1, $2); }
+: maybe_outer_attrs visibility           { $$ = mk_node(sess, NK_AttrsAndVis, 2, $1, $2); }
 ;
 
 mod_item
-: attrs_and_vis item    { $$ = mk_node("Item", 2, $1, $2); }
+: attrs_and_vis item    { $$ = mk_node(sess, NK_Item, 2, $1, $2); note_item(sess, $$, @$); }
 ;
 
 // items that can appear outside of a fn block
@@ -303,57 +358,57 @@ stmt_item
 ;
 
 item_static
-: STATIC ident ':' ty '=' expr ';'  { $$ = mk_node("ItemStatic", 3, $2, $4, $6); }
-| STATIC MUT ident ':' ty '=' expr ';'  { $$ = mk_node("ItemStatic", 3, $3, $5, $7); }
+: STATIC ident ':' ty '=' expr ';'  { $$ = mk_node(sess, NK_ItemStatic, 3, $2, $4, $6); }
+| STATIC MUT ident ':' ty '=' expr ';'  { $$ = mk_node(sess, NK_ItemStatic, 3, $3, $5, $7); }
 ;
 
 item_const
-: CONST ident ':' ty '=' expr ';'  { $$ = mk_node("ItemConst", 3, $2, $4, $6); }
+: CONST ident ':' ty '=' expr ';'  { $$ = mk_node(sess, NK_ItemConst, 3, $2, $4, $6); }
 ;
 
 item_macro
-: path_expr '!' maybe_ident parens_delimited_token_trees ';'  { $$ = mk_node("ItemMacro", 3, $1, $3, $4); }
-| path_expr '!' maybe_ident braces_delimited_token_trees      { $$ = mk_node("ItemMacro", 3, $1, $3, $4); }
-| path_expr '!' maybe_ident brackets_delimited_token_trees ';'{ $$ = mk_node("ItemMacro", 3, $1, $3, $4); }
+: path_expr '!' maybe_ident parens_delimited_token_trees ';'  { $$ = mk_node(sess, NK_ItemMacro, 3, $1, $3, $4); }
+| path_expr '!' maybe_ident braces_delimited_token_trees      { $$ = mk_node(sess, NK_ItemMacro, 3, $1, $3, $4); }
+| path_expr '!' maybe_ident brackets_delimited_token_trees ';'{ $$ = mk_node(sess, NK_ItemMacro, 3, $1, $3, $4); }
 ;
 
 view_item
 : use_item
 | extern_fn_item
-| EXTERN CRATE ident ';'                      { $$ = mk_node("ViewItemExternCrate", 1, $3); }
-| EXTERN CRATE ident AS ident ';'             { $$ = mk_node("ViewItemExternCrate", 2, $3, $5); }
+| EXTERN CRATE ident ';'                      { $$ = mk_node(sess, NK_ViewItemExternCrate, 1, $3); }
+| EXTERN CRATE ident AS ident ';'             { $$ = mk_node(sess, NK_ViewItemExternCrate, 2, $3, $5); }
 ;
 
 extern_fn_item
-: EXTERN maybe_abi item_fn                    { $$ = mk_node("ViewItemExternFn", 2, $2, $3); }
+: EXTERN maybe_abi item_fn                    { $$ = mk_node(sess, NK_ViewItemExternFn, 2, $2, $3); }
 ;
 
 use_item
-: USE view_path ';'                           { $$ = mk_node("ViewItemUse", 1, $2); }
+: USE view_path ';'                           { $$ = mk_node(sess, NK_ViewItemUse, 1, $2); }
 ;
 
 view_path
-: path_no_types_allowed                                    { $$ = mk_node("ViewPathSimple", 1, $1); }
-| path_no_types_allowed MOD_SEP '{'                '}'     { $$ = mk_node("ViewPathList", 2, $1, mk_atom("ViewPathListEmpty")); }
-|                       MOD_SEP '{'                '}'     { $$ = mk_node("ViewPathList", 1, mk_atom("ViewPathListEmpty")); }
-| path_no_types_allowed MOD_SEP '{' idents_or_self '}'     { $$ = mk_node("ViewPathList", 2, $1, $4); }
-|                       MOD_SEP '{' idents_or_self '}'     { $$ = mk_node("ViewPathList", 1, $3); }
-| path_no_types_allowed MOD_SEP '{' idents_or_self ',' '}' { $$ = mk_node("ViewPathList", 2, $1, $4); }
-|                       MOD_SEP '{' idents_or_self ',' '}' { $$ = mk_node("ViewPathList", 1, $3); }
-| path_no_types_allowed MOD_SEP '*'                        { $$ = mk_node("ViewPathGlob", 1, $1); }
-|                       MOD_SEP '*'                        { $$ = mk_atom("ViewPathGlob"); }
-|                               '*'                        { $$ = mk_atom("ViewPathGlob"); }
-|                               '{'                '}'     { $$ = mk_atom("ViewPathListEmpty"); }
-|                               '{' idents_or_self '}'     { $$ = mk_node("ViewPathList", 1, $2); }
-|                               '{' idents_or_self ',' '}' { $$ = mk_node("ViewPathList", 1, $2); }
-| path_no_types_allowed AS ident                           { $$ = mk_node("ViewPathSimple", 2, $1, $3); }
+: path_no_types_allowed                                    { $$ = mk_node(sess, NK_ViewPathSimple, 1, $1); }
+| path_no_types_allowed MOD_SEP '{'                '}'     { $$ = mk_node(sess, NK_ViewPathList, 2, $1, mk_atom(sess, "ViewPathListEmpty")); }
+|                       MOD_SEP '{'                '}'     { $$ = mk_node(sess, NK_ViewPathList, 1, mk_atom(sess, "ViewPathListEmpty")); }
+| path_no_types_allowed MOD_SEP '{' idents_or_self '}'     { $$ = mk_node(sess, NK_ViewPathList, 2, $1, $4); }
+|                       MOD_SEP '{' idents_or_self '}'     { $$ = mk_node(sess, NK_ViewPathList, 1, $3); }
+| path_no_types_allowed MOD_SEP '{' idents_or_self ',' '}' { $$ = mk_node(sess, NK_ViewPathList, 2, $1, $4); }
+|                       MOD_SEP '{' idents_or_self ',' '}' { $$ = mk_node(sess, NK_ViewPathList, 1, $3); }
+| path_no_types_allowed MOD_SEP '*'                        { $$ = mk_node(sess, NK_ViewPathGlob, 1, $1); }
+|                       MOD_SEP '*'                        { $$ = mk_atom(sess, "ViewPathGlob"); }
+|                               '*'                        { $$ = mk_atom(sess, "ViewPathGlob"); }
+|                               '{'                '}'     { $$ = mk_atom(sess, "ViewPathListEmpty"); }
+|                               '{' idents_or_self '}'     { $$ = mk_node(sess, NK_ViewPathList, 1, $2); }
+|                               '{' idents_or_self ',' '}' { $$ = mk_node(sess, NK_ViewPathList, 1, $2); }
+| path_no_types_allowed AS ident                           { $$ = mk_node(sess, NK_ViewPathSimple, 2, $1, $3); }
 ;
 
 block_item
 : item_fn
 | item_unsafe_fn
 | item_mod
-| item_foreign_mod          { $$ = mk_node("ItemForeignMod", 1, $1); }
+| item_foreign_mod          { $$ = mk_node(sess, NK_ItemForeignMod, 1, $1); }
 | item_struct
 | item_enum
 | item_union
@@ -363,27 +418,27 @@ block_item
 
 maybe_ty_ascription
 : ':' ty_sum { $$ = $2; }
-| %empty { $$ = mk_none(); }
+| %empty { $$ = mk_none(sess); }
 ;
 
 maybe_init_expr
 : '=' expr { $$ = $2; }
-| %empty   { $$ = mk_none(); }
+| %empty   { $$ = mk_none(sess); }
 ;
 
 // structs
 item_struct
 : STRUCT ident generic_params maybe_where_clause struct_decl_args
 {
-  $$ = mk_node("ItemStruct", 4, $2, $3, $4, $5);
+  $$ = mk_node(sess, NK_ItemStruct, 4, $2, $3, $4, $5);
 }
 | STRUCT ident generic_params struct_tuple_args maybe_where_clause ';'
 {
-  $$ = mk_node("ItemStruct", 4, $2, $3, $4, $5);
+  $$ = mk_node(sess, NK_ItemStruct, 4, $2, $3, $4, $5);
 }
 | STRUCT ident generic_params maybe_where_clause ';'
 {
-  $$ = mk_node("ItemStruct", 3, $2, $3, $4);
+  $$ = mk_node(sess, NK_ItemStruct, 3, $2, $3, $4);
 }
 ;
 
@@ -398,226 +453,226 @@ struct_tuple_args
 ;
 
 struct_decl_fields
-: struct_decl_field                           { $$ = mk_node("StructFields", 1, $1); }
-| struct_decl_fields ',' struct_decl_field    { $$ = ext_node($1, 1, $3); }
-| %empty                                      { $$ = mk_none(); }
+: struct_decl_field                           { $$ = mk_node(sess, NK_StructFields, 1, $1); }
+| struct_decl_fields ',' struct_decl_field    { $$ = ext_node(sess, $1, 1, $3); }
+| %empty                                      { $$ = mk_none(sess); }
 ;
 
 struct_decl_field
-: attrs_and_vis ident ':' ty_sum              { $$ = mk_node("StructField", 3, $1, $2, $4); }
+: attrs_and_vis ident ':' ty_sum              { $$ = mk_node(sess, NK_StructField, 3, $1, $2, $4); }
 ;
 
 struct_tuple_fields
-: struct_tuple_field                          { $$ = mk_node("StructFields", 1, $1); }
-| struct_tuple_fields ',' struct_tuple_field  { $$ = ext_node($1, 1, $3); }
-| %empty                                      { $$ = mk_none(); }
+: struct_tuple_field                          { $$ = mk_node(sess, NK_StructFields, 1, $1); }
+| struct_tuple_fields ',' struct_tuple_field  { $$ = ext_node(sess, $1, 1, $3); }
+| %empty                                      { $$ = mk_none(sess); }
 ;
 
 struct_tuple_field
-: attrs_and_vis ty_sum                    { $$ = mk_node("StructField", 2, $1, $2); }
+: attrs_and_vis ty_sum                    { $$ = mk_node(sess, NK_StructField, 2, $1, $2); }
 ;
 
 // enums
 item_enum
-: ENUM ident generic_params maybe_where_clause '{' enum_defs '}'     { $$ = mk_node("ItemEnum", 0); }
-| ENUM ident generic_params maybe_where_clause '{' enum_defs ',' '}' { $$ = mk_node("ItemEnum", 0); }
+: ENUM ident generic_params maybe_where_clause '{' enum_defs '}'     { $$ = mk_node(sess, NK_ItemEnum, 0); }
+| ENUM ident generic_params maybe_where_clause '{' enum_defs ',' '}' { $$ = mk_node(sess, NK_ItemEnum, 0); }
 ;
 
 enum_defs
-: enum_def               { $$ = mk_node("EnumDefs", 1, $1); }
-| enum_defs ',' enum_def { $$ = ext_node($1, 1, $3); }
-| %empty                 { $$ = mk_none(); }
+: enum_def               { $$ = mk_node(sess, NK_EnumDefs, 1, $1); }
+| enum_defs ',' enum_def { $$ = ext_node(sess, $1, 1, $3); }
+| %empty                 { $$ = mk_none(sess); }
 ;
 
 enum_def
-: attrs_and_vis ident enum_args { $$ = mk_node("EnumDef", 3, $1, $2, $3); }
+: attrs_and_vis ident enum_args { $$ = mk_node(sess, NK_EnumDef, 3, $1, $2, $3); }
 ;
 
 enum_args
-: '{' struct_decl_fields '}'     { $$ = mk_node("EnumArgs", 1, $2); }
-| '{' struct_decl_fields ',' '}' { $$ = mk_node("EnumArgs", 1, $2); }
-| '(' maybe_ty_sums ')'          { $$ = mk_node("EnumArgs", 1, $2); }
-| '=' expr                       { $$ = mk_node("EnumArgs", 1, $2); }
-| %empty                         { $$ = mk_none(); }
+: '{' struct_decl_fields '}'     { $$ = mk_node(sess, NK_EnumArgs, 1, $2); }
+| '{' struct_decl_fields ',' '}' { $$ = mk_node(sess, NK_EnumArgs, 1, $2); }
+| '(' maybe_ty_sums ')'          { $$ = mk_node(sess, NK_EnumArgs, 1, $2); }
+| '=' expr                       { $$ = mk_node(sess, NK_EnumArgs, 1, $2); }
+| %empty                         { $$ = mk_none(sess); }
 ;
 
 // unions
 item_union
-: UNION ident generic_params maybe_where_clause '{' struct_decl_fields '}'     { $$ = mk_node("ItemUnion", 0); }
-| UNION ident generic_params maybe_where_clause '{' struct_decl_fields ',' '}' { $$ = mk_node("ItemUnion", 0); }
+: UNION ident generic_params maybe_where_clause '{' struct_decl_fields '}'     { $$ = mk_node(sess, NK_ItemUnion, 0); }
+| UNION ident generic_params maybe_where_clause '{' struct_decl_fields ',' '}' { $$ = mk_node(sess, NK_ItemUnion, 0); }
 
 item_mod
-: MOD ident ';'                                 { $$ = mk_node("ItemMod", 1, $2); }
-| MOD ident '{' maybe_mod_items '}'             { $$ = mk_node("ItemMod", 2, $2, $4); }
-| MOD ident '{' inner_attrs maybe_mod_items '}' { $$ = mk_node("ItemMod", 3, $2, $4, $5); }
+: MOD ident ';'                                 { $$ = mk_node(sess, NK_ItemMod, 1, $2); }
+| MOD ident '{' maybe_mod_items '}'             { $$ = mk_node(sess, NK_ItemMod, 2, $2, $4); }
+| MOD ident '{' inner_attrs maybe_mod_items '}' { $$ = mk_node(sess, NK_ItemMod, 3, $2, $4, $5); }
 ;
 
 item_foreign_mod
-: EXTERN maybe_abi '{' maybe_foreign_items '}'             { $$ = mk_node("ItemForeignMod", 1, $4); }
-| EXTERN maybe_abi '{' inner_attrs maybe_foreign_items '}' { $$ = mk_node("ItemForeignMod", 2, $4, $5); }
+: EXTERN maybe_abi '{' maybe_foreign_items '}'             { $$ = mk_node(sess, NK_ItemForeignMod, 1, $4); }
+| EXTERN maybe_abi '{' inner_attrs maybe_foreign_items '}' { $$ = mk_node(sess, NK_ItemForeignMod, 2, $4, $5); }
 ;
 
 maybe_abi
 : str
-| %empty { $$ = mk_none(); }
+| %empty { $$ = mk_none(sess); }
 ;
 
 maybe_foreign_items
 : foreign_items
-| %empty { $$ = mk_none(); }
+| %empty { $$ = mk_none(sess); }
 ;
 
 foreign_items
-: foreign_item               { $$ = mk_node("ForeignItems", 1, $1); }
-| foreign_items foreign_item { $$ = ext_node($1, 1, $2); }
+: foreign_item               { $$ = mk_node(sess, NK_ForeignItems, 1, $1); }
+| foreign_items foreign_item { $$ = ext_node(sess, $1, 1, $2); }
 ;
 
 foreign_item
-: attrs_and_vis STATIC item_foreign_static { $$ = mk_node("ForeignItem", 2, $1, $3); }
-| attrs_and_vis item_foreign_fn            { $$ = mk_node("ForeignItem", 2, $1, $2); }
-| attrs_and_vis UNSAFE item_foreign_fn     { $$ = mk_node("ForeignItem", 2, $1, $3); }
+: attrs_and_vis STATIC item_foreign_static { $$ = mk_node(sess, NK_ForeignItem, 2, $1, $3); }
+| attrs_and_vis item_foreign_fn            { $$ = mk_node(sess, NK_ForeignItem, 2, $1, $2); }
+| attrs_and_vis UNSAFE item_foreign_fn     { $$ = mk_node(sess, NK_ForeignItem, 2, $1, $3); }
 ;
 
 item_foreign_static
-: maybe_mut ident ':' ty ';'               { $$ = mk_node("StaticItem", 3, $1, $2, $4); }
+: maybe_mut ident ':' ty ';'               { $$ = mk_node(sess, NK_StaticItem, 3, $1, $2, $4); }
 ;
 
 item_foreign_fn
-: FN ident generic_params fn_decl_allow_variadic maybe_where_clause ';' { $$ = mk_node("ForeignFn", 4, $2, $3, $4, $5); }
+: FN ident generic_params fn_decl_allow_variadic maybe_where_clause ';' { $$ = mk_node(sess, NK_ForeignFn, 4, $2, $3, $4, $5); }
 ;
 
 fn_decl_allow_variadic
-: fn_params_allow_variadic ret_ty { $$ = mk_node("FnDecl", 2, $1, $2); }
+: fn_params_allow_variadic ret_ty { $$ = mk_node(sess, NK_FnDecl, 2, $1, $2); }
 ;
 
 fn_params_allow_variadic
-: '(' ')'                      { $$ = mk_none(); }
+: '(' ')'                      { $$ = mk_none(sess); }
 | '(' params ')'               { $$ = $2; }
 | '(' params ',' ')'           { $$ = $2; }
 | '(' params ',' DOTDOTDOT ')' { $$ = $2; }
 ;
 
 visibility
-: PUB      { $$ = mk_atom("Public"); }
-| %empty   { $$ = mk_atom("Inherited"); }
+: PUB      { $$ = mk_atom(sess, "Public"); }
+| %empty   { $$ = mk_atom(sess, "Inherited"); }
 ;
 
 idents_or_self
-: ident_or_self                    { $$ = mk_node("IdentsOrSelf", 1, $1); }
-| idents_or_self AS ident          { $$ = mk_node("IdentsOrSelf", 2, $1, $3); }
-| idents_or_self ',' ident_or_self { $$ = ext_node($1, 1, $3); }
+: ident_or_self                    { $$ = mk_node(sess, NK_IdentsOrSelf, 1, $1); }
+| idents_or_self AS ident          { $$ = mk_node(sess, NK_IdentsOrSelf, 2, $1, $3); }
+| idents_or_self ',' ident_or_self { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 ident_or_self
 : ident
-| SELF  { $$ = mk_atom(yytext); }
+| SELF  { $$ = mk_atom(sess, yytext); }
 ;
 
 item_type
-: TYPE ident generic_params maybe_where_clause '=' ty_sum ';'  { $$ = mk_node("ItemTy", 4, $2, $3, $4, $6); }
+: TYPE ident generic_params maybe_where_clause '=' ty_sum ';'  { $$ = mk_node(sess, NK_ItemTy, 4, $2, $3, $4, $6); }
 ;
 
 for_sized
-: FOR '?' ident { $$ = mk_node("ForSized", 1, $3); }
-| FOR ident '?' { $$ = mk_node("ForSized", 1, $2); }
-| %empty        { $$ = mk_none(); }
+: FOR '?' ident { $$ = mk_node(sess, NK_ForSized, 1, $3); }
+| FOR ident '?' { $$ = mk_node(sess, NK_ForSized, 1, $2); }
+| %empty        { $$ = mk_none(sess); }
 ;
 
 item_trait
 : maybe_unsafe TRAIT ident generic_params for_sized maybe_ty_param_bounds maybe_where_clause '{' maybe_trait_items '}'
 {
-  $$ = mk_node("ItemTrait", 7, $1, $3, $4, $5, $6, $7, $9);
+  $$ = mk_node(sess, NK_ItemTrait, 7, $1, $3, $4, $5, $6, $7, $9);
 }
 ;
 
 maybe_trait_items
 : trait_items
-| %empty { $$ = mk_none(); }
+| %empty { $$ = mk_none(sess); }
 ;
 
 trait_items
-: trait_item               { $$ = mk_node("TraitItems", 1, $1); }
-| trait_items trait_item   { $$ = ext_node($1, 1, $2); }
+: trait_item               { $$ = mk_node(sess, NK_TraitItems, 1, $1); }
+| trait_items trait_item   { $$ = ext_node(sess, $1, 1, $2); }
 ;
 
 trait_item
 : trait_const
 | trait_type
 | trait_method
-| maybe_outer_attrs item_macro { $$ = mk_node("TraitMacroItem", 2, $1, $2); }
+| maybe_outer_attrs item_macro { $$ = mk_node(sess, NK_TraitMacroItem, 2, $1, $2); }
 ;
 
 trait_const
-: maybe_outer_attrs CONST ident maybe_ty_ascription maybe_const_default ';' { $$ = mk_node("ConstTraitItem", 4, $1, $3, $4, $5); }
+: maybe_outer_attrs CONST ident maybe_ty_ascription maybe_const_default ';' { $$ = mk_node(sess, NK_ConstTraitItem, 4, $1, $3, $4, $5); }
 ;
 
 maybe_const_default
-: '=' expr { $$ = mk_node("ConstDefault", 1, $2); }
-| %empty   { $$ = mk_none(); }
+: '=' expr { $$ = mk_node(sess, NK_ConstDefault, 1, $2); }
+| %empty   { $$ = mk_none(sess); }
 ;
 
 trait_type
-: maybe_outer_attrs TYPE ty_param ';' { $$ = mk_node("TypeTraitItem", 2, $1, $3); }
+: maybe_outer_attrs TYPE ty_param ';' { $$ = mk_node(sess, NK_TypeTraitItem, 2, $1, $3); }
 ;
 
 maybe_unsafe
-: UNSAFE { $$ = mk_atom("Unsafe"); }
-| %empty { $$ = mk_none(); }
+: UNSAFE { $$ = mk_atom(sess, "Unsafe"); }
+| %empty { $$ = mk_none(sess); }
 ;
 
 maybe_default_maybe_unsafe
-: DEFAULT UNSAFE { $$ = mk_atom("DefaultUnsafe"); }
-| DEFAULT        { $$ = mk_atom("Default"); }
-|         UNSAFE { $$ = mk_atom("Unsafe"); }
-| %empty { $$ = mk_none(); }
+: DEFAULT UNSAFE { $$ = mk_atom(sess, "DefaultUnsafe"); }
+| DEFAULT        { $$ = mk_atom(sess, "Default"); }
+|         UNSAFE { $$ = mk_atom(sess, "Unsafe"); }
+| %empty { $$ = mk_none(sess); }
 
 trait_method
-: type_method { $$ = mk_node("Required", 1, $1); }
-| method      { $$ = mk_node("Provided", 1, $1); }
+: type_method { $$ = mk_node(sess, NK_Required, 1, $1); }
+| method      { $$ = mk_node(sess, NK_Provided, 1, $1); }
 ;
 
 type_method
 : maybe_outer_attrs maybe_unsafe FN ident generic_params fn_decl_with_self_allow_anon_params maybe_where_clause ';'
 {
-  $$ = mk_node("TypeMethod", 6, $1, $2, $4, $5, $6, $7);
+  $$ = mk_node(sess, NK_TypeMethod, 6, $1, $2, $4, $5, $6, $7);
 }
 | maybe_outer_attrs CONST maybe_unsafe FN ident generic_params fn_decl_with_self_allow_anon_params maybe_where_clause ';'
 {
-  $$ = mk_node("TypeMethod", 6, $1, $3, $5, $6, $7, $8);
+  $$ = mk_node(sess, NK_TypeMethod, 6, $1, $3, $5, $6, $7, $8);
 }
 | maybe_outer_attrs maybe_unsafe EXTERN maybe_abi FN ident generic_params fn_decl_with_self_allow_anon_params maybe_where_clause ';'
 {
-  $$ = mk_node("TypeMethod", 7, $1, $2, $4, $6, $7, $8, $9);
+  $$ = mk_node(sess, NK_TypeMethod, 7, $1, $2, $4, $6, $7, $8, $9);
 }
 ;
 
 method
 : maybe_outer_attrs maybe_unsafe FN ident generic_params fn_decl_with_self_allow_anon_params maybe_where_clause inner_attrs_and_block
 {
-  $$ = mk_node("Method", 7, $1, $2, $4, $5, $6, $7, $8);
+  $$ = mk_node(sess, NK_Method, 7, $1, $2, $4, $5, $6, $7, $8);
 }
 | maybe_outer_attrs CONST maybe_unsafe FN ident generic_params fn_decl_with_self_allow_anon_params maybe_where_clause inner_attrs_and_block
 {
-  $$ = mk_node("Method", 7, $1, $3, $5, $6, $7, $8, $9);
+  $$ = mk_node(sess, NK_Method, 7, $1, $3, $5, $6, $7, $8, $9);
 }
 | maybe_outer_attrs maybe_unsafe EXTERN maybe_abi FN ident generic_params fn_decl_with_self_allow_anon_params maybe_where_clause inner_attrs_and_block
 {
-  $$ = mk_node("Method", 8, $1, $2, $4, $6, $7, $8, $9, $10);
+  $$ = mk_node(sess, NK_Method, 8, $1, $2, $4, $6, $7, $8, $9, $10);
 }
 ;
 
 impl_method
 : attrs_and_vis maybe_default maybe_unsafe FN ident generic_params fn_decl_with_self maybe_where_clause inner_attrs_and_block
 {
-  $$ = mk_node("Method", 8, $1, $2, $3, $5, $6, $7, $8, $9);
+  $$ = mk_node(sess, NK_Method, 8, $1, $2, $3, $5, $6, $7, $8, $9);
 }
 | attrs_and_vis maybe_default CONST maybe_unsafe FN ident generic_params fn_decl_with_self maybe_where_clause inner_attrs_and_block
 {
-  $$ = mk_node("Method", 8, $1, $2, $4, $6, $7, $8, $9, $10);
+  $$ = mk_node(sess, NK_Method, 8, $1, $2, $4, $6, $7, $8, $9, $10);
 }
 | attrs_and_vis maybe_default maybe_unsafe EXTERN maybe_abi FN ident generic_params fn_decl_with_self maybe_where_clause inner_attrs_and_block
 {
-  $$ = mk_node("Method", 9, $1, $2, $3, $5, $7, $8, $9, $10, $11);
+  $$ = mk_node(sess, NK_Method, 9, $1, $2, $3, $5, $7, $8, $9, $10, $11);
 }
 ;
 
@@ -639,96 +694,96 @@ impl_method
 item_impl
 : maybe_default_maybe_unsafe IMPL generic_params ty_prim_sum maybe_where_clause '{' maybe_inner_attrs maybe_impl_items '}'
 {
-  $$ = mk_node("ItemImpl", 6, $1, $3, $4, $5, $7, $8);
+  $$ = mk_node(sess, NK_ItemImpl, 6, $1, $3, $4, $5, $7, $8);
 }
 | maybe_default_maybe_unsafe IMPL generic_params '(' ty ')' maybe_where_clause '{' maybe_inner_attrs maybe_impl_items '}'
 {
-  $$ = mk_node("ItemImpl", 6, $1, $3, 5, $6, $9, $10);
+  $$ = mk_node(sess, NK_ItemImpl, 6, $1, $3, 5, $6, $9, $10);
 }
 | maybe_default_maybe_unsafe IMPL generic_params trait_ref FOR ty_sum maybe_where_clause '{' maybe_inner_attrs maybe_impl_items '}'
 {
-  $$ = mk_node("ItemImpl", 6, $3, $4, $6, $7, $9, $10);
+  $$ = mk_node(sess, NK_ItemImpl, 6, $3, $4, $6, $7, $9, $10);
 }
 | maybe_default_maybe_unsafe IMPL generic_params '!' trait_ref FOR ty_sum maybe_where_clause '{' maybe_inner_attrs maybe_impl_items '}'
 {
-  $$ = mk_node("ItemImplNeg", 7, $1, $3, $5, $7, $8, $10, $11);
+  $$ = mk_node(sess, NK_ItemImplNeg, 7, $1, $3, $5, $7, $8, $10, $11);
 }
 | maybe_default_maybe_unsafe IMPL generic_params trait_ref FOR DOTDOT '{' '}'
 {
-  $$ = mk_node("ItemImplDefault", 3, $1, $3, $4);
+  $$ = mk_node(sess, NK_ItemImplDefault, 3, $1, $3, $4);
 }
 | maybe_default_maybe_unsafe IMPL generic_params '!' trait_ref FOR DOTDOT '{' '}'
 {
-  $$ = mk_node("ItemImplDefaultNeg", 3, $1, $3, $4);
+  $$ = mk_node(sess, NK_ItemImplDefaultNeg, 3, $1, $3, $4);
 }
 ;
 
 maybe_impl_items
 : impl_items
-| %empty { $$ = mk_none(); }
+| %empty { $$ = mk_none(sess); }
 ;
 
 impl_items
-: impl_item               { $$ = mk_node("ImplItems", 1, $1); }
-| impl_item impl_items    { $$ = ext_node($1, 1, $2); }
+: impl_item               { $$ = mk_node(sess, NK_ImplItems, 1, $1); }
+| impl_items impl_item    { $$ = ext_node(sess, $1, 1, $2); }
 ;
 
 impl_item
 : impl_method
-| attrs_and_vis item_macro { $$ = mk_node("ImplMacroItem", 2, $1, $2); }
+| attrs_and_vis item_macro { $$ = mk_node(sess, NK_ImplMacroItem, 2, $1, $2); }
 | impl_const
 | impl_type
 ;
 
 maybe_default
-: DEFAULT { $$ = mk_atom("Default"); }
-| %empty { $$ = mk_none(); }
+: DEFAULT { $$ = mk_atom(sess, "Default"); }
+| %empty { $$ = mk_none(sess); }
 ;
 
 impl_const
-: attrs_and_vis maybe_default item_const { $$ = mk_node("ImplConst", 3, $1, $2, $3); }
+: attrs_and_vis maybe_default item_const { $$ = mk_node(sess, NK_ImplConst, 3, $1, $2, $3); }
 ;
 
 impl_type
-: attrs_and_vis maybe_default TYPE ident generic_params '=' ty_sum ';'  { $$ = mk_node("ImplType", 5, $1, $2, $4, $5, $7); }
+: attrs_and_vis maybe_default TYPE ident generic_params '=' ty_sum ';'  { $$ = mk_node(sess, NK_ImplType, 5, $1, $2, $4, $5, $7); }
 ;
 
 item_fn
 : FN ident generic_params fn_decl maybe_where_clause inner_attrs_and_block
 {
-  $$ = mk_node("ItemFn", 5, $2, $3, $4, $5, $6);
+  $$ = mk_node(sess, NK_ItemFn, 5, $2, $3, $4, $5, $6);
 }
 | CONST FN ident generic_params fn_decl maybe_where_clause inner_attrs_and_block
 {
-  $$ = mk_node("ItemFn", 5, $3, $4, $5, $6, $7);
+  $$ = mk_node(sess, NK_ItemFn, 5, $3, $4, $5, $6, $7);
 }
 ;
 
 item_unsafe_fn
 : UNSAFE FN ident generic_params fn_decl maybe_where_clause inner_attrs_and_block
 {
-  $$ = mk_node("ItemUnsafeFn", 5, $3, $4, $5, $6, $7);
+  $$ = mk_node(sess, NK_ItemUnsafeFn, 5, $3, $4, $5, $6, $7);
 }
 | CONST UNSAFE FN ident generic_params fn_decl maybe_where_clause inner_attrs_and_block
 {
-  $$ = mk_node("ItemUnsafeFn", 5, $4, $5, $6, $7, $8);
+  $$ = mk_node(sess, NK_ItemUnsafeFn, 5, $4, $5, $6, $7, $8);
 }
 | UNSAFE EXTERN maybe_abi FN ident generic_params fn_decl maybe_where_clause inner_attrs_and_block
 {
-  $$ = mk_node("ItemUnsafeFn", 6, $3, $5, $6, $7, $8, $9);
+  $$ = mk_node(sess, NK_ItemUnsafeFn, 6, $3, $5, $6, $7, $8, $9);
 }
 ;
 
 fn_decl
-: fn_params ret_ty   { $$ = mk_node("FnDecl", 2, $1, $2); }
+: fn_params ret_ty   { $$ = mk_node(sess, NK_FnDecl, 2, $1, $2); }
 ;
 
 fn_decl_with_self
-: fn_params_with_self ret_ty   { $$ = mk_node("FnDecl", 2, $1, $2); }
+: fn_params_with_self ret_ty   { $$ = mk_node(sess, NK_FnDecl, 2, $1, $2); }
 ;
 
 fn_decl_with_self_allow_anon_params
-: fn_anon_params_with_self ret_ty   { $$ = mk_node("FnDecl", 2, $1, $2); }
+: fn_anon_params_with_self ret_ty   { $$ = mk_node(sess, NK_FnDecl, 2, $1, $2); }
 ;
 
 fn_params
@@ -736,146 +791,141 @@ fn_params
 ;
 
 fn_anon_params
-: '(' anon_param anon_params_allow_variadic_tail ')' { $$ = ext_node($2, 1, $3); }
-| '(' ')'                                            { $$ = mk_none(); }
+: '(' anon_params ')'                { $$ = $2; }
+| '(' anon_params ',' DOTDOTDOT ')'  { $$ = $2; }
+| '(' ')'                            { $$ = mk_none(sess); }
 ;
 
 fn_params_with_self
-: '(' maybe_mut SELF maybe_ty_ascription maybe_comma_params ')'              { $$ = mk_node("SelfValue", 3, $2, $4, $5); }
-| '(' '&' maybe_mut SELF maybe_ty_ascription maybe_comma_params ')'          { $$ = mk_node("SelfRegion", 3, $3, $5, $6); }
-| '(' '&' lifetime maybe_mut SELF maybe_ty_ascription maybe_comma_params ')' { $$ = mk_node("SelfRegion", 4, $3, $4, $6, $7); }
-| '(' maybe_params ')'                                                       { $$ = mk_node("SelfStatic", 1, $2); }
+: '(' maybe_mut SELF maybe_ty_ascription maybe_comma_params ')'              { $$ = mk_node(sess, NK_SelfValue, 3, $2, $4, $5); }
+| '(' '&' maybe_mut SELF maybe_ty_ascription maybe_comma_params ')'          { $$ = mk_node(sess, NK_SelfRegion, 3, $3, $5, $6); }
+| '(' '&' lifetime maybe_mut SELF maybe_ty_ascription maybe_comma_params ')' { $$ = mk_node(sess, NK_SelfRegion, 4, $3, $4, $6, $7); }
+| '(' maybe_params ')'                                                       { $$ = mk_node(sess, NK_SelfStatic, 1, $2); }
 ;
 
 fn_anon_params_with_self
-: '(' maybe_mut SELF maybe_ty_ascription maybe_comma_anon_params ')'              { $$ = mk_node("SelfValue", 3, $2, $4, $5); }
-| '(' '&' maybe_mut SELF maybe_ty_ascription maybe_comma_anon_params ')'          { $$ = mk_node("SelfRegion", 3, $3, $5, $6); }
-| '(' '&' lifetime maybe_mut SELF maybe_ty_ascription maybe_comma_anon_params ')' { $$ = mk_node("SelfRegion", 4, $3, $4, $6, $7); }
-| '(' maybe_anon_params ')'                                                       { $$ = mk_node("SelfStatic", 1, $2); }
+: '(' maybe_mut SELF maybe_ty_ascription maybe_comma_anon_params ')'              { $$ = mk_node(sess, NK_SelfValue, 3, $2, $4, $5); }
+| '(' '&' maybe_mut SELF maybe_ty_ascription maybe_comma_anon_params ')'          { $$ = mk_node(sess, NK_SelfRegion, 3, $3, $5, $6); }
+| '(' '&' lifetime maybe_mut SELF maybe_ty_ascription maybe_comma_anon_params ')' { $$ = mk_node(sess, NK_SelfRegion, 4, $3, $4, $6, $7); }
+| '(' maybe_anon_params ')'                                                       { $$ = mk_node(sess, NK_SelfStatic, 1, $2); }
 ;
 
 maybe_params
 : params
 | params ','
-| %empty  { $$ = mk_none(); }
+| %empty  { $$ = mk_none(sess); }
 ;
 
 params
-: param                { $$ = mk_node("Args", 1, $1); }
-| params ',' param     { $$ = ext_node($1, 1, $3); }
+: param                { $$ = mk_node(sess, NK_Args, 1, $1); }
+| params ',' param     { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 param
-: pat ':' ty_sum   { $$ = mk_node("Arg", 2, $1, $3); }
+: pat ':' ty_sum   { $$ = mk_node(sess, NK_Arg, 2, $1, $3); }
 ;
 
 inferrable_params
-: inferrable_param                       { $$ = mk_node("InferrableParams", 1, $1); }
-| inferrable_params ',' inferrable_param { $$ = ext_node($1, 1, $3); }
+: inferrable_param                       { $$ = mk_node(sess, NK_InferrableParams, 1, $1); }
+| inferrable_params ',' inferrable_param { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 inferrable_param
-: pat maybe_ty_ascription { $$ = mk_node("InferrableParam", 2, $1, $2); }
+: pat maybe_ty_ascription { $$ = mk_node(sess, NK_InferrableParam, 2, $1, $2); }
 ;
 
 maybe_comma_params
-: ','            { $$ = mk_none(); }
+: ','            { $$ = mk_none(sess); }
 | ',' params     { $$ = $2; }
 | ',' params ',' { $$ = $2; }
-| %empty         { $$ = mk_none(); }
+| %empty         { $$ = mk_none(sess); }
 ;
 
 maybe_comma_anon_params
-: ','                 { $$ = mk_none(); }
+: ','                 { $$ = mk_none(sess); }
 | ',' anon_params     { $$ = $2; }
 | ',' anon_params ',' { $$ = $2; }
-| %empty              { $$ = mk_none(); }
+| %empty              { $$ = mk_none(sess); }
 ;
 
 maybe_anon_params
 : anon_params
 | anon_params ','
-| %empty      { $$ = mk_none(); }
+| %empty      { $$ = mk_none(sess); }
 ;
 
 anon_params
-: anon_param                 { $$ = mk_node("Args", 1, $1); }
-| anon_params ',' anon_param { $$ = ext_node($1, 1, $3); }
+: anon_param                 { $$ = mk_node(sess, NK_Args, 1, $1); }
+| anon_params ',' anon_param { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 // anon means it's allowed to be anonymous (type-only), but it can
 // still have a name
 anon_param
-: named_arg ':' ty   { $$ = mk_node("Arg", 2, $1, $3); }
+: named_arg ':' ty   { $$ = mk_node(sess, NK_Arg, 2, $1, $3); }
 | ty
 ;
 
-anon_params_allow_variadic_tail
-: ',' DOTDOTDOT                                  { $$ = mk_none(); }
-| ',' anon_param anon_params_allow_variadic_tail { $$ = mk_node("Args", 2, $2, $3); }
-| %empty                                         { $$ = mk_none(); }
-;
-
 named_arg
 : ident
-| UNDERSCORE        { $$ = mk_atom("PatWild"); }
+| UNDERSCORE        { $$ = mk_atom(sess, "PatWild"); }
 | '&' ident         { $$ = $2; }
-| '&' UNDERSCORE    { $$ = mk_atom("PatWild"); }
+| '&' UNDERSCORE    { $$ = mk_atom(sess, "PatWild"); }
 | ANDAND ident      { $$ = $2; }
-| ANDAND UNDERSCORE { $$ = mk_atom("PatWild"); }
+| ANDAND UNDERSCORE { $$ = mk_atom(sess, "PatWild"); }
 | MUT ident         { $$ = $2; }
 ;
 
 ret_ty
-: RARROW '!'         { $$ = mk_none(); }
-| RARROW ty          { $$ = mk_node("ret-ty", 1, $2); }
-| %prec IDENT %empty { $$ = mk_none(); }
+: RARROW '!'         { $$ = mk_none(sess); }
+| RARROW ty          { $$ = mk_node(sess, NK_ret_ty, 1, $2); }
+| %prec IDENT %empty { $$ = mk_none(sess); }
 ;
 
 generic_params
-: '<' '>'                             { $$ = mk_node("Generics", 2, mk_none(), mk_none()); }
-| '<' lifetimes '>'                   { $$ = mk_node("Generics", 2, $2, mk_none()); }
-| '<' lifetimes ',' '>'               { $$ = mk_node("Generics", 2, $2, mk_none()); }
-| '<' lifetimes SHR                   { push_back('>'); $$ = mk_node("Generics", 2, $2, mk_none()); }
-| '<' lifetimes ',' SHR               { push_back('>'); $$ = mk_node("Generics", 2, $2, mk_none()); }
-| '<' lifetimes ',' ty_params '>'     { $$ = mk_node("Generics", 2, $2, $4); }
-| '<' lifetimes ',' ty_params ',' '>' { $$ = mk_node("Generics", 2, $2, $4); }
-| '<' lifetimes ',' ty_params SHR     { push_back('>'); $$ = mk_node("Generics", 2, $2, $4); }
-| '<' lifetimes ',' ty_params ',' SHR { push_back('>'); $$ = mk_node("Generics", 2, $2, $4); }
-| '<' ty_params '>'                   { $$ = mk_node("Generics", 2, mk_none(), $2); }
-| '<' ty_params ',' '>'               { $$ = mk_node("Generics", 2, mk_none(), $2); }
-| '<' ty_params SHR                   { push_back('>'); $$ = mk_node("Generics", 2, mk_none(), $2); }
-| '<' ty_params ',' SHR               { push_back('>'); $$ = mk_node("Generics", 2, mk_none(), $2); }
-| %empty                              { $$ = mk_none(); }
+: '<' '>'                             { $$ = mk_node(sess, NK_Generics, 2, mk_none(sess), mk_none(sess)); }
+| '<' lifetimes '>'                   { $$ = mk_node(sess, NK_Generics, 2, $2, mk_none(sess)); }
+| '<' lifetimes ',' '>'               { $$ = mk_node(sess, NK_Generics, 2, $2, mk_none(sess)); }
+| '<' lifetimes SHR                   { push_back(sess, '>'); $$ = mk_node(sess, NK_Generics, 2, $2, mk_none(sess)); }
+| '<' lifetimes ',' SHR               { push_back(sess, '>'); $$ = mk_node(sess, NK_Generics, 2, $2, mk_none(sess)); }
+| '<' lifetimes ',' ty_params '>'     { $$ = mk_node(sess, NK_Generics, 2, $2, $4); }
+| '<' lifetimes ',' ty_params ',' '>' { $$ = mk_node(sess, NK_Generics, 2, $2, $4); }
+| '<' lifetimes ',' ty_params SHR     { push_back(sess, '>'); $$ = mk_node(sess, NK_Generics, 2, $2, $4); }
+| '<' lifetimes ',' ty_params ',' SHR { push_back(sess, '>'); $$ = mk_node(sess, NK_Generics, 2, $2, $4); }
+| '<' ty_params '>'                   { $$ = mk_node(sess, NK_Generics, 2, mk_none(sess), $2); }
+| '<' ty_params ',' '>'               { $$ = mk_node(sess, NK_Generics, 2, mk_none(sess), $2); }
+| '<' ty_params SHR                   { push_back(sess, '>'); $$ = mk_node(sess, NK_Generics, 2, mk_none(sess), $2); }
+| '<' ty_params ',' SHR               { push_back(sess, '>'); $$ = mk_node(sess, NK_Generics, 2, mk_none(sess), $2); }
+| %empty                              { $$ = mk_none(sess); }
 ;
 
 maybe_where_clause
-: %empty                              { $$ = mk_none(); }
+: %empty                              { $$ = mk_none(sess); }
 | where_clause
 ;
 
 where_clause
-: WHERE where_predicates              { $$ = mk_node("WhereClause", 1, $2); }
-| WHERE where_predicates ','          { $$ = mk_node("WhereClause", 1, $2); }
+: WHERE where_predicates              { $$ = mk_node(sess, NK_WhereClause, 1, $2); }
+| WHERE where_predicates ','          { $$ = mk_node(sess, NK_WhereClause, 1, $2); }
 ;
 
 where_predicates
-: where_predicate                      { $$ = mk_node("WherePredicates", 1, $1); }
-| where_predicates ',' where_predicate { $$ = ext_node($1, 1, $3); }
+: where_predicate                      { $$ = mk_node(sess, NK_WherePredicates, 1, $1); }
+| where_predicates ',' where_predicate { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 where_predicate
-: maybe_for_lifetimes lifetime ':' bounds    { $$ = mk_node("WherePredicate", 3, $1, $2, $4); }
-| maybe_for_lifetimes ty ':' ty_param_bounds { $$ = mk_node("WherePredicate", 3, $1, $2, $4); }
+: maybe_for_lifetimes lifetime ':' bounds    { $$ = mk_node(sess, NK_WherePredicate, 3, $1, $2, $4); }
+| maybe_for_lifetimes ty ':' ty_param_bounds { $$ = mk_node(sess, NK_WherePredicate, 3, $1, $2, $4); }
 ;
 
 maybe_for_lifetimes
-: FOR '<' lifetimes '>' { $$ = mk_none(); }
-| %prec FORTYPE %empty  { $$ = mk_none(); }
+: FOR '<' lifetimes '>' { $$ = mk_none(sess); }
+| %prec FORTYPE %empty  { $$ = mk_none(sess); }
 
 ty_params
-: ty_param               { $$ = mk_node("TyParams", 1, $1); }
-| ty_params ',' ty_param { $$ = ext_node($1, 1, $3); }
+: ty_param               { $$ = mk_node(sess, NK_TyParams, 1, $1); }
+| ty_params ',' ty_param { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 // A path with no type parameters; e.g. `foo::bar::Baz`
@@ -883,13 +933,13 @@ ty_params
 // These show up in 'use' view-items, because these are processed
 // without respect to types.
 path_no_types_allowed
-: ident                               { $$ = mk_node("ViewPath", 1, $1); }
-| MOD_SEP ident                       { $$ = mk_node("ViewPath", 1, $2); }
-| SELF                                { $$ = mk_node("ViewPath", 1, mk_atom("Self")); }
-| MOD_SEP SELF                        { $$ = mk_node("ViewPath", 1, mk_atom("Self")); }
-| SUPER                               { $$ = mk_node("ViewPath", 1, mk_atom("Super")); }
-| MOD_SEP SUPER                       { $$ = mk_node("ViewPath", 1, mk_atom("Super")); }
-| path_no_types_allowed MOD_SEP ident { $$ = ext_node($1, 1, $3); }
+: ident                               { $$ = mk_node(sess, NK_ViewPath, 1, $1); }
+| MOD_SEP ident                       { $$ = mk_node(sess, NK_ViewPath, 1, $2); }
+| SELF                                { $$ = mk_node(sess, NK_ViewPath, 1, mk_atom(sess, "Self")); }
+| MOD_SEP SELF                        { $$ = mk_node(sess, NK_ViewPath, 1, mk_atom(sess, "Self")); }
+| SUPER                               { $$ = mk_node(sess, NK_ViewPath, 1, mk_atom(sess, "Super")); }
+| MOD_SEP SUPER                       { $$ = mk_node(sess, NK_ViewPath, 1, mk_atom(sess, "Super")); }
+| path_no_types_allowed MOD_SEP ident { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 // A path with a lifetime and type parameters, with no double colons
@@ -905,50 +955,50 @@ path_no_types_allowed
 // be ambiguous with.
 path_generic_args_without_colons
 : %prec IDENT
-  ident                                                                       { $$ = mk_node("components", 1, $1); }
+  ident                                                                       { $$ = mk_node(sess, NK_components, 1, $1); }
 | %prec IDENT
-  ident generic_args                                                          { $$ = mk_node("components", 2, $1, $2); }
+  ident generic_args                                                          { $$ = mk_node(sess, NK_components, 2, $1, $2); }
 | %prec IDENT
-  ident '(' maybe_ty_sums ')' ret_ty                                          { $$ = mk_node("components", 2, $1, $3); }
+  ident '(' maybe_ty_sums ')' ret_ty                                          { $$ = mk_node(sess, NK_components, 2, $1, $3); }
 | %prec IDENT
-  path_generic_args_without_colons MOD_SEP ident                              { $$ = ext_node($1, 1, $3); }
+  path_generic_args_without_colons MOD_SEP ident                              { $$ = ext_node(sess, $1, 1, $3); }
 | %prec IDENT
-  path_generic_args_without_colons MOD_SEP ident generic_args                 { $$ = ext_node($1, 2, $3, $4); }
+  path_generic_args_without_colons MOD_SEP ident generic_args                 { $$ = ext_node(sess, $1, 2, $3, $4); }
 | %prec IDENT
-  path_generic_args_without_colons MOD_SEP ident '(' maybe_ty_sums ')' ret_ty { $$ = ext_node($1, 2, $3, $5); }
+  path_generic_args_without_colons MOD_SEP ident '(' maybe_ty_sums ')' ret_ty { $$ = ext_node(sess, $1, 2, $3, $5); }
 ;
 
 generic_args
 : '<' generic_values '>'   { $$ = $2; }
-| '<' generic_values SHR   { push_back('>'); $$ = $2; }
-| '<' generic_values GE    { push_back('='); $$ = $2; }
-| '<' generic_values SHREQ { push_back('>'); push_back('='); $$ = $2; }
+| '<' generic_values SHR   { push_back(sess, '>'); $$ = $2; }
+| '<' generic_values GE    { push_back(sess, '='); $$ = $2; }
+| '<' generic_values SHREQ { push_back(sess, '>'); push_back(sess, '='); $$ = $2; }
 // If generic_args starts with "<<", the first arg must be a
 // TyQualifiedPath because that's the only type that can start with a
 // '<'. This rule parses that as the first ty_sum and then continues
 // with the rest of generic_values.
 | SHL ty_qualified_path_and_generic_values '>'   { $$ = $2; }
-| SHL ty_qualified_path_and_generic_values SHR   { push_back('>'); $$ = $2; }
-| SHL ty_qualified_path_and_generic_values GE    { push_back('='); $$ = $2; }
-| SHL ty_qualified_path_and_generic_values SHREQ { push_back('>'); push_back('='); $$ = $2; }
+| SHL ty_qualified_path_and_generic_values SHR   { push_back(sess, '>'); $$ = $2; }
+| SHL ty_qualified_path_and_generic_values GE    { push_back(sess, '='); $$ = $2; }
+| SHL ty_qualified_path_and_generic_values SHREQ { push_back(sess, '>'); push_back(sess, '='); $$ = $2; }
 ;
 
 generic_values
-: maybe_ty_sums_and_or_bindings { $$ = mk_node("GenericValues", 1, $1); }
+: maybe_ty_sums_and_or_bindings { $$ = mk_node(sess, NK_GenericValues, 1, $1); }
 ;
 
 maybe_ty_sums_and_or_bindings
 : ty_sums
 | ty_sums ','
-| ty_sums ',' bindings { $$ = mk_node("TySumsAndBindings", 2, $1, $3); }
+| ty_sums ',' bindings { $$ = mk_node(sess, NK_TySumsAndBindings, 2, $1, $3); }
 | bindings
 | bindings ','
-| %empty               { $$ = mk_none(); }
+| %empty               { $$ = mk_none(sess); }
 ;
 
 maybe_bindings
 : ',' bindings { $$ = $2; }
-| %empty       { $$ = mk_none(); }
+| %empty       { $$ = mk_none(sess); }
 ;
 
 ////////////////////////////////////////////////////////////////////////
@@ -956,107 +1006,107 @@ maybe_bindings
 ////////////////////////////////////////////////////////////////////////
 
 pat
-: UNDERSCORE                                      { $$ = mk_atom("PatWild"); }
-| '&' pat                                         { $$ = mk_node("PatRegion", 1, $2); }
-| '&' MUT pat                                     { $$ = mk_node("PatRegion", 1, $3); }
-| ANDAND pat                                      { $$ = mk_node("PatRegion", 1, mk_node("PatRegion", 1, $2)); }
-| '(' ')'                                         { $$ = mk_atom("PatUnit"); }
-| '(' pat_tup ')'                                 { $$ = mk_node("PatTup", 1, $2); }
-| '[' pat_vec ']'                                 { $$ = mk_node("PatVec", 1, $2); }
+: UNDERSCORE                                      { $$ = mk_atom(sess, "PatWild"); }
+| '&' pat                                         { $$ = mk_node(sess, NK_PatRegion, 1, $2); }
+| '&' MUT pat                                     { $$ = mk_node(sess, NK_PatRegion, 1, $3); }
+| ANDAND pat                                      { $$ = mk_node(sess, NK_PatRegion, 1, mk_node(sess, NK_PatRegion, 1, $2)); }
+| '(' ')'                                         { $$ = mk_atom(sess, "PatUnit"); }
+| '(' pat_tup ')'                                 { $$ = mk_node(sess, NK_PatTup, 1, $2); }
+| '[' pat_vec ']'                                 { $$ = mk_node(sess, NK_PatVec, 1, $2); }
 | lit_or_path
-| lit_or_path DOTDOTDOT lit_or_path               { $$ = mk_node("PatRange", 2, $1, $3); }
-| path_expr '{' pat_struct '}'                    { $$ = mk_node("PatStruct", 2, $1, $3); }
-| path_expr '(' ')'                               { $$ = mk_node("PatEnum", 2, $1, mk_none()); }
-| path_expr '(' pat_tup ')'                       { $$ = mk_node("PatEnum", 2, $1, $3); }
-| path_expr '!' maybe_ident delimited_token_trees { $$ = mk_node("PatMac", 3, $1, $3, $4); }
-| binding_mode ident                              { $$ = mk_node("PatIdent", 2, $1, $2); }
-|              ident '@' pat                      { $$ = mk_node("PatIdent", 3, mk_node("BindByValue", 1, mk_atom("MutImmutable")), $1, $3); }
-| binding_mode ident '@' pat                      { $$ = mk_node("PatIdent", 3, $1, $2, $4); }
-| BOX pat                                         { $$ = mk_node("PatUniq", 1, $2); }
-| '<' ty_sum maybe_as_trait_ref '>' MOD_SEP ident { $$ = mk_node("PatQualifiedPath", 3, $2, $3, $6); }
+| lit_or_path DOTDOTDOT lit_or_path               { $$ = mk_node(sess, NK_PatRange, 2, $1, $3); }
+| path_expr '{' pat_struct '}'                    { $$ = mk_node(sess, NK_PatStruct, 2, $1, $3); }
+| path_expr '(' ')'                               { $$ = mk_node(sess, NK_PatEnum, 2, $1, mk_none(sess)); }
+| path_expr '(' pat_tup ')'                       { $$ = mk_node(sess, NK_PatEnum, 2, $1, $3); }
+| path_expr '!' maybe_ident delimited_token_trees { $$ = mk_node(sess, NK_PatMac, 3, $1, $3, $4); }
+| binding_mode ident                              { $$ = mk_node(sess, NK_PatIdent, 2, $1, $2); }
+|              ident '@' pat                      { $$ = mk_node(sess, NK_PatIdent, 3, mk_node(sess, NK_BindByValue, 1, mk_atom(sess, "MutImmutable")), $1, $3); }
+| binding_mode ident '@' pat                      { $$ = mk_node(sess, NK_PatIdent, 3, $1, $2, $4); }
+| BOX pat                                         { $$ = mk_node(sess, NK_PatUniq, 1, $2); }
+| '<' ty_sum maybe_as_trait_ref '>' MOD_SEP ident { $$ = mk_node(sess, NK_PatQualifiedPath, 3, $2, $3, $6); }
 | SHL ty_sum maybe_as_trait_ref '>' MOD_SEP ident maybe_as_trait_ref '>' MOD_SEP ident
 {
-  $$ = mk_node("PatQualifiedPath", 3, mk_node("PatQualifiedPath", 3, $2, $3, $6), $7, $10);
+  $$ = mk_node(sess, NK_PatQualifiedPath, 3, mk_node(sess, NK_PatQualifiedPath, 3, $2, $3, $6), $7, $10);
 }
 ;
 
 pats_or
-: pat              { $$ = mk_node("Pats", 1, $1); }
-| pats_or '|' pat  { $$ = ext_node($1, 1, $3); }
+: pat              { $$ = mk_node(sess, NK_Pats, 1, $1); }
+| pats_or '|' pat  { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 binding_mode
-: REF         { $$ = mk_node("BindByRef", 1, mk_atom("MutImmutable")); }
-| REF MUT     { $$ = mk_node("BindByRef", 1, mk_atom("MutMutable")); }
-| MUT         { $$ = mk_node("BindByValue", 1, mk_atom("MutMutable")); }
+: REF         { $$ = mk_node(sess, NK_BindByRef, 1, mk_atom(sess, "MutImmutable")); }
+| REF MUT     { $$ = mk_node(sess, NK_BindByRef, 1, mk_atom(sess, "MutMutable")); }
+| MUT         { $$ = mk_node(sess, NK_BindByValue, 1, mk_atom(sess, "MutMutable")); }
 ;
 
 lit_or_path
-: path_expr    { $$ = mk_node("PatLit", 1, $1); }
-| lit          { $$ = mk_node("PatLit", 1, $1); }
-| '-' lit      { $$ = mk_node("PatLit", 1, $2); }
+: path_expr    { $$ = mk_node(sess, NK_PatLit, 1, $1); }
+| lit          { $$ = mk_node(sess, NK_PatLit, 1, $1); }
+| '-' lit      { $$ = mk_node(sess, NK_PatLit, 1, $2); }
 ;
 
 pat_field
-:                  ident        { $$ = mk_node("PatField", 1, $1); }
-|     binding_mode ident        { $$ = mk_node("PatField", 2, $1, $2); }
-| BOX              ident        { $$ = mk_node("PatField", 2, mk_atom("box"), $2); }
-| BOX binding_mode ident        { $$ = mk_node("PatField", 3, mk_atom("box"), $2, $3); }
-|              ident ':' pat    { $$ = mk_node("PatField", 2, $1, $3); }
-| binding_mode ident ':' pat    { $$ = mk_node("PatField", 3, $1, $2, $4); }
-|        LIT_INTEGER ':' pat    { $$ = mk_node("PatField", 2, mk_atom(yytext), $3); }
+:                  ident        { $$ = mk_node(sess, NK_PatField, 1, $1); }
+|     binding_mode ident        { $$ = mk_node(sess, NK_PatField, 2, $1, $2); }
+| BOX              ident        { $$ = mk_node(sess, NK_PatField, 2, mk_atom(sess, "box"), $2); }
+| BOX binding_mode ident        { $$ = mk_node(sess, NK_PatField, 3, mk_atom(sess, "box"), $2, $3); }
+|              ident ':' pat    { $$ = mk_node(sess, NK_PatField, 2, $1, $3); }
+| binding_mode ident ':' pat    { $$ = mk_node(sess, NK_PatField, 3, $1, $2, $4); }
+|        LIT_INTEGER ':' pat    { $$ = mk_node(sess, NK_PatField, 2, mk_atom(sess, yytext), $3); }
 ;
 
 pat_fields
-: pat_field                  { $$ = mk_node("PatFields", 1, $1); }
-| pat_fields ',' pat_field   { $$ = ext_node($1, 1, $3); }
+: pat_field                  { $$ = mk_node(sess, NK_PatFields, 1, $1); }
+| pat_fields ',' pat_field   { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 pat_struct
-: pat_fields                 { $$ = mk_node("PatStruct", 2, $1, mk_atom("false")); }
-| pat_fields ','             { $$ = mk_node("PatStruct", 2, $1, mk_atom("false")); }
-| pat_fields ',' DOTDOT      { $$ = mk_node("PatStruct", 2, $1, mk_atom("true")); }
-| DOTDOT                     { $$ = mk_node("PatStruct", 1, mk_atom("true")); }
-| %empty                     { $$ = mk_node("PatStruct", 1, mk_none()); }
+: pat_fields                 { $$ = mk_node(sess, NK_PatStruct, 2, $1, mk_atom(sess, "false")); }
+| pat_fields ','             { $$ = mk_node(sess, NK_PatStruct, 2, $1, mk_atom(sess, "false")); }
+| pat_fields ',' DOTDOT      { $$ = mk_node(sess, NK_PatStruct, 2, $1, mk_atom(sess, "true")); }
+| DOTDOT                     { $$ = mk_node(sess, NK_PatStruct, 1, mk_atom(sess, "true")); }
+| %empty                     { $$ = mk_node(sess, NK_PatStruct, 1, mk_none(sess)); }
 ;
 
 pat_tup
-: pat_tup_elts                                  { $$ = mk_node("PatTup", 2, $1, mk_none()); }
-| pat_tup_elts                             ','  { $$ = mk_node("PatTup", 2, $1, mk_none()); }
-| pat_tup_elts     DOTDOT                       { $$ = mk_node("PatTup", 2, $1, mk_none()); }
-| pat_tup_elts ',' DOTDOT                       { $$ = mk_node("PatTup", 2, $1, mk_none()); }
-| pat_tup_elts     DOTDOT ',' pat_tup_elts      { $$ = mk_node("PatTup", 2, $1, $4); }
-| pat_tup_elts     DOTDOT ',' pat_tup_elts ','  { $$ = mk_node("PatTup", 2, $1, $4); }
-| pat_tup_elts ',' DOTDOT ',' pat_tup_elts      { $$ = mk_node("PatTup", 2, $1, $5); }
-| pat_tup_elts ',' DOTDOT ',' pat_tup_elts ','  { $$ = mk_node("PatTup", 2, $1, $5); }
-|                  DOTDOT ',' pat_tup_elts      { $$ = mk_node("PatTup", 2, mk_none(), $3); }
-|                  DOTDOT ',' pat_tup_elts ','  { $$ = mk_node("PatTup", 2, mk_none(), $3); }
-|                  DOTDOT                       { $$ = mk_node("PatTup", 2, mk_none(), mk_none()); }
+: pat_tup_elts                                  { $$ = mk_node(sess, NK_PatTup, 2, $1, mk_none(sess)); }
+| pat_tup_elts                             ','  { $$ = mk_node(sess, NK_PatTup, 2, $1, mk_none(sess)); }
+| pat_tup_elts     DOTDOT                       { $$ = mk_node(sess, NK_PatTup, 2, $1, mk_none(sess)); }
+| pat_tup_elts ',' DOTDOT                       { $$ = mk_node(sess, NK_PatTup, 2, $1, mk_none(sess)); }
+| pat_tup_elts     DOTDOT ',' pat_tup_elts      { $$ = mk_node(sess, NK_PatTup, 2, $1, $4); }
+| pat_tup_elts     DOTDOT ',' pat_tup_elts ','  { $$ = mk_node(sess, NK_PatTup, 2, $1, $4); }
+| pat_tup_elts ',' DOTDOT ',' pat_tup_elts      { $$ = mk_node(sess, NK_PatTup, 2, $1, $5); }
+| pat_tup_elts ',' DOTDOT ',' pat_tup_elts ','  { $$ = mk_node(sess, NK_PatTup, 2, $1, $5); }
+|                  DOTDOT ',' pat_tup_elts      { $$ = mk_node(sess, NK_PatTup, 2, mk_none(sess), $3); }
+|                  DOTDOT ',' pat_tup_elts ','  { $$ = mk_node(sess, NK_PatTup, 2, mk_none(sess), $3); }
+|                  DOTDOT                       { $$ = mk_node(sess, NK_PatTup, 2, mk_none(sess), mk_none(sess)); }
 ;
 
 pat_tup_elts
-: pat                    { $$ = mk_node("PatTupElts", 1, $1); }
-| pat_tup_elts ',' pat   { $$ = ext_node($1, 1, $3); }
+: pat                    { $$ = mk_node(sess, NK_PatTupElts, 1, $1); }
+| pat_tup_elts ',' pat   { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 pat_vec
-: pat_vec_elts                                  { $$ = mk_node("PatVec", 2, $1, mk_none()); }
-| pat_vec_elts                             ','  { $$ = mk_node("PatVec", 2, $1, mk_none()); }
-| pat_vec_elts     DOTDOT                       { $$ = mk_node("PatVec", 2, $1, mk_none()); }
-| pat_vec_elts ',' DOTDOT                       { $$ = mk_node("PatVec", 2, $1, mk_none()); }
-| pat_vec_elts     DOTDOT ',' pat_vec_elts      { $$ = mk_node("PatVec", 2, $1, $4); }
-| pat_vec_elts     DOTDOT ',' pat_vec_elts ','  { $$ = mk_node("PatVec", 2, $1, $4); }
-| pat_vec_elts ',' DOTDOT ',' pat_vec_elts      { $$ = mk_node("PatVec", 2, $1, $5); }
-| pat_vec_elts ',' DOTDOT ',' pat_vec_elts ','  { $$ = mk_node("PatVec", 2, $1, $5); }
-|                  DOTDOT ',' pat_vec_elts      { $$ = mk_node("PatVec", 2, mk_none(), $3); }
-|                  DOTDOT ',' pat_vec_elts ','  { $$ = mk_node("PatVec", 2, mk_none(), $3); }
-|                  DOTDOT                       { $$ = mk_node("PatVec", 2, mk_none(), mk_none()); }
-| %empty                                        { $$ = mk_node("PatVec", 2, mk_none(), mk_none()); }
+: pat_vec_elts                                  { $$ = mk_node(sess, NK_PatVec, 2, $1, mk_none(sess)); }
+| pat_vec_elts                             ','  { $$ = mk_node(sess, NK_PatVec, 2, $1, mk_none(sess)); }
+| pat_vec_elts     DOTDOT                       { $$ = mk_node(sess, NK_PatVec, 2, $1, mk_none(sess)); }
+| pat_vec_elts ',' DOTDOT                       { $$ = mk_node(sess, NK_PatVec, 2, $1, mk_none(sess)); }
+| pat_vec_elts     DOTDOT ',' pat_vec_elts      { $$ = mk_node(sess, NK_PatVec, 2, $1, $4); }
+| pat_vec_elts     DOTDOT ',' pat_vec_elts ','  { $$ = mk_node(sess, NK_PatVec, 2, $1, $4); }
+| pat_vec_elts ',' DOTDOT ',' pat_vec_elts      { $$ = mk_node(sess, NK_PatVec, 2, $1, $5); }
+| pat_vec_elts ',' DOTDOT ',' pat_vec_elts ','  { $$ = mk_node(sess, NK_PatVec, 2, $1, $5); }
+|                  DOTDOT ',' pat_vec_elts      { $$ = mk_node(sess, NK_PatVec, 2, mk_none(sess), $3); }
+|                  DOTDOT ',' pat_vec_elts ','  { $$ = mk_node(sess, NK_PatVec, 2, mk_none(sess), $3); }
+|                  DOTDOT                       { $$ = mk_node(sess, NK_PatVec, 2, mk_none(sess), mk_none(sess)); }
+| %empty                                        { $$ = mk_node(sess, NK_PatVec, 2, mk_none(sess), mk_none(sess)); }
 ;
 
 pat_vec_elts
-: pat                    { $$ = mk_node("PatVecElts", 1, $1); }
-| pat_vec_elts ',' pat   { $$ = ext_node($1, 1, $3); }
+: pat                    { $$ = mk_node(sess, NK_PatVecElts, 1, $1); }
+| pat_vec_elts ',' pat   { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 ////////////////////////////////////////////////////////////////////////
@@ -1066,32 +1116,32 @@ pat_vec_elts
 ty
 : ty_prim
 | ty_closure
-| '<' ty_sum maybe_as_trait_ref '>' MOD_SEP ident                                      { $$ = mk_node("TyQualifiedPath", 3, $2, $3, $6); }
-| SHL ty_sum maybe_as_trait_ref '>' MOD_SEP ident maybe_as_trait_ref '>' MOD_SEP ident { $$ = mk_node("TyQualifiedPath", 3, mk_node("TyQualifiedPath", 3, $2, $3, $6), $7, $10); }
-| '(' ty_sums ')'                                                                      { $$ = mk_node("TyTup", 1, $2); }
-| '(' ty_sums ',' ')'                                                                  { $$ = mk_node("TyTup", 1, $2); }
-| '(' ')'                                                                              { $$ = mk_atom("TyNil"); }
+| '<' ty_sum maybe_as_trait_ref '>' MOD_SEP ident                                      { $$ = mk_node(sess, NK_TyQualifiedPath, 3, $2, $3, $6); }
+| SHL ty_sum maybe_as_trait_ref '>' MOD_SEP ident maybe_as_trait_ref '>' MOD_SEP ident { $$ = mk_node(sess, NK_TyQualifiedPath, 3, mk_node(sess, NK_TyQualifiedPath, 3, $2, $3, $6), $7, $10); }
+| '(' ty_sums ')'                                                                      { $$ = mk_node(sess, NK_TyTup, 1, $2); }
+| '(' ty_sums ',' ')'                                                                  { $$ = mk_node(sess, NK_TyTup, 1, $2); }
+| '(' ')'                                                                              { $$ = mk_atom(sess, "TyNil"); }
 ;
 
 ty_prim
-: %prec IDENT path_generic_args_without_colons                                               { $$ = mk_node("TyPath", 2, mk_node("global", 1, mk_atom("false")), $1); }
-| %prec IDENT MOD_SEP path_generic_args_without_colons                                       { $$ = mk_node("TyPath", 2, mk_node("global", 1, mk_atom("true")), $2); }
-| %prec IDENT SELF MOD_SEP path_generic_args_without_colons                                  { $$ = mk_node("TyPath", 2, mk_node("self", 1, mk_atom("true")), $3); }
-| %prec IDENT path_generic_args_without_colons '!' maybe_ident delimited_token_trees         { $$ = mk_node("TyMacro", 3, $1, $3, $4); }
-| %prec IDENT MOD_SEP path_generic_args_without_colons '!' maybe_ident delimited_token_trees { $$ = mk_node("TyMacro", 3, $2, $4, $5); }
-| BOX ty                                                                                     { $$ = mk_node("TyBox", 1, $2); }
-| '*' maybe_mut_or_const ty                                                                  { $$ = mk_node("TyPtr", 2, $2, $3); }
-| '&' ty                                                                                     { $$ = mk_node("TyRptr", 2, mk_atom("MutImmutable"), $2); }
-| '&' MUT ty                                                                                 { $$ = mk_node("TyRptr", 2, mk_atom("MutMutable"), $3); }
-| ANDAND ty                                                                                  { $$ = mk_node("TyRptr", 1, mk_node("TyRptr", 2, mk_atom("MutImmutable"), $2)); }
-| ANDAND MUT ty                                                                              { $$ = mk_node("TyRptr", 1, mk_node("TyRptr", 2, mk_atom("MutMutable"), $3)); }
-| '&' lifetime maybe_mut ty                                                                  { $$ = mk_node("TyRptr", 3, $2, $3, $4); }
-| ANDAND lifetime maybe_mut ty                                                               { $$ = mk_node("TyRptr", 1, mk_node("TyRptr", 3, $2, $3, $4)); }
-| '[' ty ']'                                                                                 { $$ = mk_node("TyVec", 1, $2); }
-| '[' ty ',' DOTDOT expr ']'                                                                 { $$ = mk_node("TyFixedLengthVec", 2, $2, $5); }
-| '[' ty ';' expr ']'                                                                        { $$ = mk_node("TyFixedLengthVec", 2, $2, $4); }
-| TYPEOF '(' expr ')'                                                                        { $$ = mk_node("TyTypeof", 1, $3); }
-| UNDERSCORE                                                                                 { $$ = mk_atom("TyInfer"); }
+: %prec IDENT path_generic_args_without_colons                                               { $$ = mk_node(sess, NK_TyPath, 2, mk_node(sess, NK_global, 1, mk_atom(sess, "false")), $1); }
+| %prec IDENT MOD_SEP path_generic_args_without_colons                                       { $$ = mk_node(sess, NK_TyPath, 2, mk_node(sess, NK_global, 1, mk_atom(sess, "true")), $2); }
+| %prec IDENT SELF MOD_SEP path_generic_args_without_colons                                  { $$ = mk_node(sess, NK_TyPath, 2, mk_node(sess, NK_self, 1, mk_atom(sess, "true")), $3); }
+| %prec IDENT path_generic_args_without_colons '!' maybe_ident delimited_token_trees         { $$ = mk_node(sess, NK_TyMacro, 3, $1, $3, $4); }
+| %prec IDENT MOD_SEP path_generic_args_without_colons '!' maybe_ident delimited_token_trees { $$ = mk_node(sess, NK_TyMacro, 3, $2, $4, $5); }
+| BOX ty                                                                                     { $$ = mk_node(sess, NK_TyBox, 1, $2); }
+| '*' maybe_mut_or_const ty                                                                  { $$ = mk_node(sess, NK_TyPtr, 2, $2, $3); }
+| '&' ty                                                                                     { $$ = mk_node(sess, NK_TyRptr, 2, mk_atom(sess, "MutImmutable"), $2); }
+| '&' MUT ty                                                                                 { $$ = mk_node(sess, NK_TyRptr, 2, mk_atom(sess, "MutMutable"), $3); }
+| ANDAND ty                                                                                  { $$ = mk_node(sess, NK_TyRptr, 1, mk_node(sess, NK_TyRptr, 2, mk_atom(sess, "MutImmutable"), $2)); }
+| ANDAND MUT ty                                                                              { $$ = mk_node(sess, NK_TyRptr, 1, mk_node(sess, NK_TyRptr, 2, mk_atom(sess, "MutMutable"), $3)); }
+| '&' lifetime maybe_mut ty                                                                  { $$ = mk_node(sess, NK_TyRptr, 3, $2, $3, $4); }
+| ANDAND lifetime maybe_mut ty                                                               { $$ = mk_node(sess, NK_TyRptr, 1, mk_node(sess, NK_TyRptr, 3, $2, $3, $4)); }
+| '[' ty ']'                                                                                 { $$ = mk_node(sess, NK_TyVec, 1, $2); }
+| '[' ty ',' DOTDOT expr ']'                                                                 { $$ = mk_node(sess, NK_TyFixedLengthVec, 2, $2, $5); }
+| '[' ty ';' expr ']'                                                                        { $$ = mk_node(sess, NK_TyFixedLengthVec, 2, $2, $4); }
+| TYPEOF '(' expr ')'                                                                        { $$ = mk_node(sess, NK_TyTypeof, 1, $3); }
+| UNDERSCORE                                                                                 { $$ = mk_atom(sess, "TyInfer"); }
 | ty_bare_fn
 | for_in_type
 ;
@@ -1104,18 +1154,18 @@ ty_bare_fn
 ;
 
 ty_fn_decl
-: generic_params fn_anon_params ret_ty { $$ = mk_node("TyFnDecl", 3, $1, $2, $3); }
+: generic_params fn_anon_params ret_ty { $$ = mk_node(sess, NK_TyFnDecl, 3, $1, $2, $3); }
 ;
 
 ty_closure
-: UNSAFE '|' anon_params '|' maybe_bounds ret_ty { $$ = mk_node("TyClosure", 3, $3, $5, $6); }
-|        '|' anon_params '|' maybe_bounds ret_ty { $$ = mk_node("TyClosure", 3, $2, $4, $5); }
-| UNSAFE OROR maybe_bounds ret_ty                { $$ = mk_node("TyClosure", 2, $3, $4); }
-|        OROR maybe_bounds ret_ty                { $$ = mk_node("TyClosure", 2, $2, $3); }
+: UNSAFE '|' anon_params '|' maybe_bounds ret_ty { $$ = mk_node(sess, NK_TyClosure, 3, $3, $5, $6); }
+|        '|' anon_params '|' maybe_bounds ret_ty { $$ = mk_node(sess, NK_TyClosure, 3, $2, $4, $5); }
+| UNSAFE OROR maybe_bounds ret_ty                { $$ = mk_node(sess, NK_TyClosure, 2, $3, $4); }
+|        OROR maybe_bounds ret_ty                { $$ = mk_node(sess, NK_TyClosure, 2, $2, $3); }
 ;
 
 for_in_type
-: FOR '<' maybe_lifetimes '>' for_in_type_suffix { $$ = mk_node("ForInType", 2, $3, $5); }
+: FOR '<' maybe_lifetimes '>' for_in_type_suffix { $$ = mk_node(sess, NK_ForInType, 2, $3, $5); }
 ;
 
 for_in_type_suffix
@@ -1125,46 +1175,46 @@ for_in_type_suffix
 ;
 
 maybe_mut
-: MUT              { $$ = mk_atom("MutMutable"); }
-| %prec MUT %empty { $$ = mk_atom("MutImmutable"); }
+: MUT              { $$ = mk_atom(sess, "MutMutable"); }
+| %prec MUT %empty { $$ = mk_atom(sess, "MutImmutable"); }
 ;
 
 maybe_mut_or_const
-: MUT    { $$ = mk_atom("MutMutable"); }
-| CONST  { $$ = mk_atom("MutImmutable"); }
-| %empty { $$ = mk_atom("MutImmutable"); }
+: MUT    { $$ = mk_atom(sess, "MutMutable"); }
+| CONST  { $$ = mk_atom(sess, "MutImmutable"); }
+| %empty { $$ = mk_atom(sess, "MutImmutable"); }
 ;
 
 ty_qualified_path_and_generic_values
 : ty_qualified_path maybe_bindings
 {
-  $$ = mk_node("GenericValues", 3, mk_none(), mk_node("TySums", 1, mk_node("TySum", 1, $1)), $2);
+  $$ = mk_node(sess, NK_GenericValues, 3, mk_none(sess), mk_node(sess, NK_TySums, 1, mk_node(sess, NK_TySum, 1, $1)), $2);
 }
 | ty_qualified_path ',' ty_sums maybe_bindings
 {
-  $$ = mk_node("GenericValues", 3, mk_none(), mk_node("TySums", 2, $1, $3), $4);
+  $$ = mk_node(sess, NK_GenericValues, 3, mk_none(sess), mk_node(sess, NK_TySums, 2, $1, $3), $4);
 }
 ;
 
 ty_qualified_path
-: ty_sum AS trait_ref '>' MOD_SEP ident                     { $$ = mk_node("TyQualifiedPath", 3, $1, $3, $6); }
-| ty_sum AS trait_ref '>' MOD_SEP ident '+' ty_param_bounds { $$ = mk_node("TyQualifiedPath", 3, $1, $3, $6); }
+: ty_sum AS trait_ref '>' MOD_SEP ident                     { $$ = mk_node(sess, NK_TyQualifiedPath, 3, $1, $3, $6); }
+| ty_sum AS trait_ref '>' MOD_SEP ident '+' ty_param_bounds { $$ = mk_node(sess, NK_TyQualifiedPath, 3, $1, $3, $6); }
 ;
 
 maybe_ty_sums
 : ty_sums
 | ty_sums ','
-| %empty { $$ = mk_none(); }
+| %empty { $$ = mk_none(sess); }
 ;
 
 ty_sums
-: ty_sum             { $$ = mk_node("TySums", 1, $1); }
-| ty_sums ',' ty_sum { $$ = ext_node($1, 1, $3); }
+: ty_sum             { $$ = mk_node(sess, NK_TySums, 1, $1); }
+| ty_sums ',' ty_sum { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 ty_sum
-: ty_sum_elt            { $$ = mk_node("TySum", 1, $1); }
-| ty_sum '+' ty_sum_elt { $$ = ext_node($1, 1, $3); }
+: ty_sum_elt            { $$ = mk_node(sess, NK_TySum, 1, $1); }
+| ty_sum '+' ty_sum_elt { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 ty_sum_elt
@@ -1173,8 +1223,8 @@ ty_sum_elt
 ;
 
 ty_prim_sum
-: ty_prim_sum_elt                 { $$ = mk_node("TySum", 1, $1); }
-| ty_prim_sum '+' ty_prim_sum_elt { $$ = ext_node($1, 1, $3); }
+: ty_prim_sum_elt                 { $$ = mk_node(sess, NK_TySum, 1, $1); }
+| ty_prim_sum '+' ty_prim_sum_elt { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 ty_prim_sum_elt
@@ -1184,49 +1234,49 @@ ty_prim_sum_elt
 
 maybe_ty_param_bounds
 : ':' ty_param_bounds { $$ = $2; }
-| %empty              { $$ = mk_none(); }
+| %empty              { $$ = mk_none(sess); }
 ;
 
 ty_param_bounds
 : boundseq
-| %empty { $$ = mk_none(); }
+| %empty { $$ = mk_none(sess); }
 ;
 
 boundseq
 : polybound
-| boundseq '+' polybound { $$ = ext_node($1, 1, $3); }
+| boundseq '+' polybound { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 polybound
-: FOR '<' maybe_lifetimes '>' bound { $$ = mk_node("PolyBound", 2, $3, $5); }
+: FOR '<' maybe_lifetimes '>' bound { $$ = mk_node(sess, NK_PolyBound, 2, $3, $5); }
 | bound
-| '?' FOR '<' maybe_lifetimes '>' bound { $$ = mk_node("PolyBound", 2, $4, $6); }
+| '?' FOR '<' maybe_lifetimes '>' bound { $$ = mk_node(sess, NK_PolyBound, 2, $4, $6); }
 | '?' bound { $$ = $2; }
 ;
 
 bindings
-: binding              { $$ = mk_node("Bindings", 1, $1); }
-| bindings ',' binding { $$ = ext_node($1, 1, $3); }
+: binding              { $$ = mk_node(sess, NK_Bindings, 1, $1); }
+| bindings ',' binding { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 binding
-: ident '=' ty { mk_node("Binding", 2, $1, $3); }
+: ident '=' ty { mk_node(sess, NK_Binding, 2, $1, $3); }
 ;
 
 ty_param
-: ident maybe_ty_param_bounds maybe_ty_default           { $$ = mk_node("TyParam", 3, $1, $2, $3); }
-| ident '?' ident maybe_ty_param_bounds maybe_ty_default { $$ = mk_node("TyParam", 4, $1, $3, $4, $5); }
+: ident maybe_ty_param_bounds maybe_ty_default           { $$ = mk_node(sess, NK_TyParam, 3, $1, $2, $3); }
+| ident '?' ident maybe_ty_param_bounds maybe_ty_default { $$ = mk_node(sess, NK_TyParam, 4, $1, $3, $4, $5); }
 ;
 
 maybe_bounds
 : %prec SHIFTPLUS
   ':' bounds             { $$ = $2; }
-| %prec SHIFTPLUS %empty { $$ = mk_none(); }
+| %prec SHIFTPLUS %empty { $$ = mk_none(sess); }
 ;
 
 bounds
-: bound            { $$ = mk_node("bounds", 1, $1); }
-| bounds '+' bound { $$ = ext_node($1, 1, $3); }
+: bound            { $$ = mk_node(sess, NK_bounds, 1, $1); }
+| bounds '+' bound { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 bound
@@ -1237,38 +1287,38 @@ bound
 maybe_ltbounds
 : %prec SHIFTPLUS
   ':' ltbounds       { $$ = $2; }
-| %empty             { $$ = mk_none(); }
+| %empty             { $$ = mk_none(sess); }
 ;
 
 ltbounds
-: lifetime              { $$ = mk_node("ltbounds", 1, $1); }
-| ltbounds '+' lifetime { $$ = ext_node($1, 1, $3); }
+: lifetime              { $$ = mk_node(sess, NK_ltbounds, 1, $1); }
+| ltbounds '+' lifetime { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 maybe_ty_default
-: '=' ty_sum { $$ = mk_node("TyDefault", 1, $2); }
-| %empty     { $$ = mk_none(); }
+: '=' ty_sum { $$ = mk_node(sess, NK_TyDefault, 1, $2); }
+| %empty     { $$ = mk_none(sess); }
 ;
 
 maybe_lifetimes
 : lifetimes
 | lifetimes ','
-| %empty { $$ = mk_none(); }
+| %empty { $$ = mk_none(sess); }
 ;
 
 lifetimes
-: lifetime_and_bounds               { $$ = mk_node("Lifetimes", 1, $1); }
-| lifetimes ',' lifetime_and_bounds { $$ = ext_node($1, 1, $3); }
+: lifetime_and_bounds               { $$ = mk_node(sess, NK_Lifetimes, 1, $1); }
+| lifetimes ',' lifetime_and_bounds { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 lifetime_and_bounds
-: LIFETIME maybe_ltbounds         { $$ = mk_node("lifetime", 2, mk_atom(yytext), $2); }
-| STATIC_LIFETIME                 { $$ = mk_atom("static_lifetime"); }
+: LIFETIME maybe_ltbounds         { $$ = mk_node(sess, NK_lifetime, 2, mk_atom(sess, yytext), $2); }
+| STATIC_LIFETIME                 { $$ = mk_atom(sess, "static_lifetime"); }
 ;
 
 lifetime
-: LIFETIME         { $$ = mk_node("lifetime", 1, mk_atom(yytext)); }
-| STATIC_LIFETIME  { $$ = mk_atom("static_lifetime"); }
+: LIFETIME         { $$ = mk_node(sess, NK_lifetime, 1, mk_atom(sess, yytext)); }
+| STATIC_LIFETIME  { $$ = mk_atom(sess, "static_lifetime"); }
 ;
 
 trait_ref
@@ -1281,18 +1331,18 @@ trait_ref
 ////////////////////////////////////////////////////////////////////////
 
 inner_attrs_and_block
-: '{' maybe_inner_attrs maybe_stmts '}'        { $$ = mk_node("ExprBlock", 2, $2, $3); }
+: '{' maybe_inner_attrs maybe_stmts '}'        { $$ = mk_node(sess, NK_ExprBlock, 2, $2, $3); }
 ;
 
 block
-: '{' maybe_stmts '}'                          { $$ = mk_node("ExprBlock", 1, $2); }
+: '{' maybe_stmts '}'                          { $$ = mk_node(sess, NK_ExprBlock, 1, $2); }
 ;
 
 maybe_stmts
 : stmts
-| stmts nonblock_expr { $$ = ext_node($1, 1, $2); }
+| stmts nonblock_expr { $$ = ext_node(sess, $1, 1, $2); }
 | nonblock_expr
-| %empty              { $$ = mk_none(); }
+| %empty              { $$ = mk_none(sess); }
 ;
 
 // There are two sub-grammars within a "stmts: exprs" derivation
@@ -1320,8 +1370,8 @@ maybe_stmts
 // In non-stmts contexts, expr can relax this trichotomy.
 
 stmts
-: stmt           { $$ = mk_node("stmts", 1, $1); }
-| stmts stmt     { $$ = ext_node($1, 1, $2); }
+: stmt           { $$ = mk_node(sess, NK_stmts, 1, $1); }
+| stmts stmt     { $$ = ext_node(sess, $1, 1, $2); }
 ;
 
 stmt
@@ -1334,29 +1384,29 @@ stmt
 | maybe_outer_attrs block   { $$ = $2; }
 |             nonblock_expr ';'
 | outer_attrs nonblock_expr ';' { $$ = $2; }
-| ';'                   { $$ = mk_none(); }
+| ';'                   { $$ = mk_none(sess); }
 ;
 
 maybe_exprs
 : exprs
 | exprs ','
-| %empty { $$ = mk_none(); }
+| %empty { $$ = mk_none(sess); }
 ;
 
 maybe_expr
 : expr
-| %empty { $$ = mk_none(); }
+| %empty { $$ = mk_none(sess); }
 ;
 
 exprs
-: expr                                                        { $$ = mk_node("exprs", 1, $1); }
-| exprs ',' expr                                              { $$ = ext_node($1, 1, $3); }
+: expr                                                        { $$ = mk_node(sess, NK_exprs, 1, $1); }
+| exprs ',' expr                                              { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 path_expr
 : path_generic_args_with_colons
 | MOD_SEP path_generic_args_with_colons      { $$ = $2; }
-| SELF MOD_SEP path_generic_args_with_colons { $$ = mk_node("SelfPath", 1, $3); }
+| SELF MOD_SEP path_generic_args_with_colons { $$ = mk_node(sess, NK_SelfPath, 1, $3); }
 ;
 
 // A path with a lifetime and type parameters with double colons before
@@ -1365,141 +1415,141 @@ path_expr
 // These show up in expr context, in order to disambiguate from "less-than"
 // expressions.
 path_generic_args_with_colons
-: ident                                              { $$ = mk_node("components", 1, $1); }
-| SUPER                                              { $$ = mk_atom("Super"); }
-| path_generic_args_with_colons MOD_SEP ident        { $$ = ext_node($1, 1, $3); }
-| path_generic_args_with_colons MOD_SEP SUPER        { $$ = ext_node($1, 1, mk_atom("Super")); }
-| path_generic_args_with_colons MOD_SEP generic_args { $$ = ext_node($1, 1, $3); }
+: ident                                              { $$ = mk_node(sess, NK_components, 1, $1); }
+| SUPER                                              { $$ = mk_atom(sess, "Super"); }
+| path_generic_args_with_colons MOD_SEP ident        { $$ = ext_node(sess, $1, 1, $3); }
+| path_generic_args_with_colons MOD_SEP SUPER        { $$ = ext_node(sess, $1, 1, mk_atom(sess, "Super")); }
+| path_generic_args_with_colons MOD_SEP generic_args { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 // the braces-delimited macro is a block_expr so it doesn't appear here
 macro_expr
-: path_expr '!' maybe_ident parens_delimited_token_trees   { $$ = mk_node("MacroExpr", 3, $1, $3, $4); }
-| path_expr '!' maybe_ident brackets_delimited_token_trees { $$ = mk_node("MacroExpr", 3, $1, $3, $4); }
+: path_expr '!' maybe_ident parens_delimited_token_trees   { $$ = mk_node(sess, NK_MacroExpr, 3, $1, $3, $4); }
+| path_expr '!' maybe_ident brackets_delimited_token_trees { $$ = mk_node(sess, NK_MacroExpr, 3, $1, $3, $4); }
 ;
 
 nonblock_expr
-: lit                                                           { $$ = mk_node("ExprLit", 1, $1); }
+: lit                                                           { $$ = mk_node(sess, NK_ExprLit, 1, $1); }
 | %prec IDENT
-  path_expr                                                     { $$ = mk_node("ExprPath", 1, $1); }
-| SELF                                                          { $$ = mk_node("ExprPath", 1, mk_node("ident", 1, mk_atom("self"))); }
-| macro_expr                                                    { $$ = mk_node("ExprMac", 1, $1); }
-| path_expr '{' struct_expr_fields '}'                          { $$ = mk_node("ExprStruct", 2, $1, $3); }
-| nonblock_expr '?'                                             { $$ = mk_node("ExprTry", 1, $1); }
-| nonblock_expr '.' path_generic_args_with_colons               { $$ = mk_node("ExprField", 2, $1, $3); }
-| nonblock_expr '.' LIT_INTEGER                                 { $$ = mk_node("ExprTupleIndex", 1, $1); }
-| nonblock_expr '[' maybe_expr ']'                              { $$ = mk_node("ExprIndex", 2, $1, $3); }
-| nonblock_expr '(' maybe_exprs ')'                             { $$ = mk_node("ExprCall", 2, $1, $3); }
-| '[' vec_expr ']'                                              { $$ = mk_node("ExprVec", 1, $2); }
-| '(' maybe_exprs ')'                                           { $$ = mk_node("ExprParen", 1, $2); }
-| CONTINUE                                                      { $$ = mk_node("ExprAgain", 0); }
-| CONTINUE lifetime                                             { $$ = mk_node("ExprAgain", 1, $2); }
-| RETURN                                                        { $$ = mk_node("ExprRet", 0); }
-| RETURN expr                                                   { $$ = mk_node("ExprRet", 1, $2); }
-| BREAK                                                         { $$ = mk_node("ExprBreak", 0); }
-| BREAK lifetime                                                { $$ = mk_node("ExprBreak", 1, $2); }
-| YIELD                                                         { $$ = mk_node("ExprYield", 0); }
-| YIELD expr                                                    { $$ = mk_node("ExprYield", 1, $2); }
-| nonblock_expr LARROW expr                                     { $$ = mk_node("ExprInPlace", 2, $1, $3); }
-| nonblock_expr '=' expr                                        { $$ = mk_node("ExprAssign", 2, $1, $3); }
-| nonblock_expr SHLEQ expr                                      { $$ = mk_node("ExprAssignShl", 2, $1, $3); }
-| nonblock_expr SHREQ expr                                      { $$ = mk_node("ExprAssignShr", 2, $1, $3); }
-| nonblock_expr MINUSEQ expr                                    { $$ = mk_node("ExprAssignSub", 2, $1, $3); }
-| nonblock_expr ANDEQ expr                                      { $$ = mk_node("ExprAssignBitAnd", 2, $1, $3); }
-| nonblock_expr OREQ expr                                       { $$ = mk_node("ExprAssignBitOr", 2, $1, $3); }
-| nonblock_expr PLUSEQ expr                                     { $$ = mk_node("ExprAssignAdd", 2, $1, $3); }
-| nonblock_expr STAREQ expr                                     { $$ = mk_node("ExprAssignMul", 2, $1, $3); }
-| nonblock_expr SLASHEQ expr                                    { $$ = mk_node("ExprAssignDiv", 2, $1, $3); }
-| nonblock_expr CARETEQ expr                                    { $$ = mk_node("ExprAssignBitXor", 2, $1, $3); }
-| nonblock_expr PERCENTEQ expr                                  { $$ = mk_node("ExprAssignRem", 2, $1, $3); }
-| nonblock_expr OROR expr                                       { $$ = mk_node("ExprBinary", 3, mk_atom("BiOr"), $1, $3); }
-| nonblock_expr ANDAND expr                                     { $$ = mk_node("ExprBinary", 3, mk_atom("BiAnd"), $1, $3); }
-| nonblock_expr EQEQ expr                                       { $$ = mk_node("ExprBinary", 3, mk_atom("BiEq"), $1, $3); }
-| nonblock_expr NE expr                                         { $$ = mk_node("ExprBinary", 3, mk_atom("BiNe"), $1, $3); }
-| nonblock_expr '<' expr                                        { $$ = mk_node("ExprBinary", 3, mk_atom("BiLt"), $1, $3); }
-| nonblock_expr '>' expr                                        { $$ = mk_node("ExprBinary", 3, mk_atom("BiGt"), $1, $3); }
-| nonblock_expr LE expr                                         { $$ = mk_node("ExprBinary", 3, mk_atom("BiLe"), $1, $3); }
-| nonblock_expr GE expr                                         { $$ = mk_node("ExprBinary", 3, mk_atom("BiGe"), $1, $3); }
-| nonblock_expr '|' expr                                        { $$ = mk_node("ExprBinary", 3, mk_atom("BiBitOr"), $1, $3); }
-| nonblock_expr '^' expr                                        { $$ = mk_node("ExprBinary", 3, mk_atom("BiBitXor"), $1, $3); }
-| nonblock_expr '&' expr                                        { $$ = mk_node("ExprBinary", 3, mk_atom("BiBitAnd"), $1, $3); }
-| nonblock_expr SHL expr                                        { $$ = mk_node("ExprBinary", 3, mk_atom("BiShl"), $1, $3); }
-| nonblock_expr SHR expr                                        { $$ = mk_node("ExprBinary", 3, mk_atom("BiShr"), $1, $3); }
-| nonblock_expr '+' expr                                        { $$ = mk_node("ExprBinary", 3, mk_atom("BiAdd"), $1, $3); }
-| nonblock_expr '-' expr                                        { $$ = mk_node("ExprBinary", 3, mk_atom("BiSub"), $1, $3); }
-| nonblock_expr '*' expr                                        { $$ = mk_node("ExprBinary", 3, mk_atom("BiMul"), $1, $3); }
-| nonblock_expr '/' expr                                        { $$ = mk_node("ExprBinary", 3, mk_atom("BiDiv"), $1, $3); }
-| nonblock_expr '%' expr                                        { $$ = mk_node("ExprBinary", 3, mk_atom("BiRem"), $1, $3); }
-| nonblock_expr DOTDOT                                          { $$ = mk_node("ExprRange", 2, $1, mk_none()); }
-| nonblock_expr DOTDOT expr                                     { $$ = mk_node("ExprRange", 2, $1, $3); }
-|               DOTDOT expr                                     { $$ = mk_node("ExprRange", 2, mk_none(), $2); }
-|               DOTDOT                                          { $$ = mk_node("ExprRange", 2, mk_none(), mk_none()); }
-| nonblock_expr AS ty                                           { $$ = mk_node("ExprCast", 2, $1, $3); }
-| nonblock_expr ':' ty                                          { $$ = mk_node("ExprTypeAscr", 2, $1, $3); }
-| BOX expr                                                      { $$ = mk_node("ExprBox", 1, $2); }
+  path_expr                                                     { $$ = mk_node(sess, NK_ExprPath, 1, $1); }
+| SELF                                                          { $$ = mk_node(sess, NK_ExprPath, 1, mk_node(sess, NK_ident, 1, mk_atom(sess, "self"))); }
+| macro_expr                                                    { $$ = mk_node(sess, NK_ExprMac, 1, $1); }
+| path_expr '{' struct_expr_fields '}'                          { $$ = mk_node(sess, NK_ExprStruct, 2, $1, $3); }
+| nonblock_expr '?'                                             { $$ = mk_node(sess, NK_ExprTry, 1, $1); }
+| nonblock_expr '.' path_generic_args_with_colons               { $$ = mk_node(sess, NK_ExprField, 2, $1, $3); }
+| nonblock_expr '.' LIT_INTEGER                                 { $$ = mk_node(sess, NK_ExprTupleIndex, 1, $1); }
+| nonblock_expr '[' maybe_expr ']'                              { $$ = mk_node(sess, NK_ExprIndex, 2, $1, $3); }
+| nonblock_expr '(' maybe_exprs ')'                             { $$ = mk_node(sess, NK_ExprCall, 2, $1, $3); }
+| '[' vec_expr ']'                                              { $$ = mk_node(sess, NK_ExprVec, 1, $2); }
+| '(' maybe_exprs ')'                                           { $$ = mk_node(sess, NK_ExprParen, 1, $2); }
+| CONTINUE                                                      { $$ = mk_node(sess, NK_ExprAgain, 0); }
+| CONTINUE lifetime                                             { $$ = mk_node(sess, NK_ExprAgain, 1, $2); }
+| RETURN                                                        { $$ = mk_node(sess, NK_ExprRet, 0); }
+| RETURN expr                                                   { $$ = mk_node(sess, NK_ExprRet, 1, $2); }
+| BREAK                                                         { $$ = mk_node(sess, NK_ExprBreak, 0); }
+| BREAK lifetime                                                { $$ = mk_node(sess, NK_ExprBreak, 1, $2); }
+| YIELD                                                         { $$ = mk_node(sess, NK_ExprYield, 0); }
+| YIELD expr                                                    { $$ = mk_node(sess, NK_ExprYield, 1, $2); }
+| nonblock_expr LARROW expr                                     { $$ = mk_node(sess, NK_ExprInPlace, 2, $1, $3); }
+| nonblock_expr '=' expr                                        { $$ = mk_node(sess, NK_ExprAssign, 2, $1, $3); }
+| nonblock_expr SHLEQ expr                                      { $$ = mk_node(sess, NK_ExprAssignShl, 2, $1, $3); }
+| nonblock_expr SHREQ expr                                      { $$ = mk_node(sess, NK_ExprAssignShr, 2, $1, $3); }
+| nonblock_expr MINUSEQ expr                                    { $$ = mk_node(sess, NK_ExprAssignSub, 2, $1, $3); }
+| nonblock_expr ANDEQ expr                                      { $$ = mk_node(sess, NK_ExprAssignBitAnd, 2, $1, $3); }
+| nonblock_expr OREQ expr                                       { $$ = mk_node(sess, NK_ExprAssignBitOr, 2, $1, $3); }
+| nonblock_expr PLUSEQ expr                                     { $$ = mk_node(sess, NK_ExprAssignAdd, 2, $1, $3); }
+| nonblock_expr STAREQ expr                                     { $$ = mk_node(sess, NK_ExprAssignMul, 2, $1, $3); }
+| nonblock_expr SLASHEQ expr                                    { $$ = mk_node(sess, NK_ExprAssignDiv, 2, $1, $3); }
+| nonblock_expr CARETEQ expr                                    { $$ = mk_node(sess, NK_ExprAssignBitXor, 2, $1, $3); }
+| nonblock_expr PERCENTEQ expr                                  { $$ = mk_node(sess, NK_ExprAssignRem, 2, $1, $3); }
+| nonblock_expr OROR expr                                       { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiOr"), $1, $3); }
+| nonblock_expr ANDAND expr                                     { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiAnd"), $1, $3); }
+| nonblock_expr EQEQ expr                                       { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiEq"), $1, $3); }
+| nonblock_expr NE expr                                         { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiNe"), $1, $3); }
+| nonblock_expr '<' expr                                        { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiLt"), $1, $3); }
+| nonblock_expr '>' expr                                        { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiGt"), $1, $3); }
+| nonblock_expr LE expr                                         { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiLe"), $1, $3); }
+| nonblock_expr GE expr                                         { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiGe"), $1, $3); }
+| nonblock_expr '|' expr                                        { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiBitOr"), $1, $3); }
+| nonblock_expr '^' expr                                        { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiBitXor"), $1, $3); }
+| nonblock_expr '&' expr                                        { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiBitAnd"), $1, $3); }
+| nonblock_expr SHL expr                                        { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiShl"), $1, $3); }
+| nonblock_expr SHR expr                                        { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiShr"), $1, $3); }
+| nonblock_expr '+' expr                                        { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiAdd"), $1, $3); }
+| nonblock_expr '-' expr                                        { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiSub"), $1, $3); }
+| nonblock_expr '*' expr                                        { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiMul"), $1, $3); }
+| nonblock_expr '/' expr                                        { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiDiv"), $1, $3); }
+| nonblock_expr '%' expr                                        { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiRem"), $1, $3); }
+| nonblock_expr DOTDOT                                          { $$ = mk_node(sess, NK_ExprRange, 2, $1, mk_none(sess)); }
+| nonblock_expr DOTDOT expr                                     { $$ = mk_node(sess, NK_ExprRange, 2, $1, $3); }
+|               DOTDOT expr                                     { $$ = mk_node(sess, NK_ExprRange, 2, mk_none(sess), $2); }
+|               DOTDOT                                          { $$ = mk_node(sess, NK_ExprRange, 2, mk_none(sess), mk_none(sess)); }
+| nonblock_expr AS ty                                           { $$ = mk_node(sess, NK_ExprCast, 2, $1, $3); }
+| nonblock_expr ':' ty                                          { $$ = mk_node(sess, NK_ExprTypeAscr, 2, $1, $3); }
+| BOX expr                                                      { $$ = mk_node(sess, NK_ExprBox, 1, $2); }
 | expr_qualified_path
 | nonblock_prefix_expr
 ;
 
 expr
-: lit                                                 { $$ = mk_node("ExprLit", 1, $1); }
+: lit                                                 { $$ = mk_node(sess, NK_ExprLit, 1, $1); }
 | %prec IDENT
-  path_expr                                           { $$ = mk_node("ExprPath", 1, $1); }
-| SELF                                                { $$ = mk_node("ExprPath", 1, mk_node("ident", 1, mk_atom("self"))); }
-| macro_expr                                          { $$ = mk_node("ExprMac", 1, $1); }
-| path_expr '{' struct_expr_fields '}'                { $$ = mk_node("ExprStruct", 2, $1, $3); }
-| expr '?'                                            { $$ = mk_node("ExprTry", 1, $1); }
-| expr '.' path_generic_args_with_colons              { $$ = mk_node("ExprField", 2, $1, $3); }
-| expr '.' LIT_INTEGER                                { $$ = mk_node("ExprTupleIndex", 1, $1); }
-| expr '[' maybe_expr ']'                             { $$ = mk_node("ExprIndex", 2, $1, $3); }
-| expr '(' maybe_exprs ')'                            { $$ = mk_node("ExprCall", 2, $1, $3); }
-| '(' maybe_exprs ')'                                 { $$ = mk_node("ExprParen", 1, $2); }
-| '[' vec_expr ']'                                    { $$ = mk_node("ExprVec", 1, $2); }
-| CONTINUE                                            { $$ = mk_node("ExprAgain", 0); }
-| CONTINUE ident                                      { $$ = mk_node("ExprAgain", 1, $2); }
-| RETURN                                              { $$ = mk_node("ExprRet", 0); }
-| RETURN expr                                         { $$ = mk_node("ExprRet", 1, $2); }
-| BREAK                                               { $$ = mk_node("ExprBreak", 0); }
-| BREAK ident                                         { $$ = mk_node("ExprBreak", 1, $2); }
-| YIELD                                               { $$ = mk_node("ExprYield", 0); }
-| YIELD expr                                          { $$ = mk_node("ExprYield", 1, $2); }
-| expr LARROW expr                                    { $$ = mk_node("ExprInPlace", 2, $1, $3); }
-| expr '=' expr                                       { $$ = mk_node("ExprAssign", 2, $1, $3); }
-| expr SHLEQ expr                                     { $$ = mk_node("ExprAssignShl", 2, $1, $3); }
-| expr SHREQ expr                                     { $$ = mk_node("ExprAssignShr", 2, $1, $3); }
-| expr MINUSEQ expr                                   { $$ = mk_node("ExprAssignSub", 2, $1, $3); }
-| expr ANDEQ expr                                     { $$ = mk_node("ExprAssignBitAnd", 2, $1, $3); }
-| expr OREQ expr                                      { $$ = mk_node("ExprAssignBitOr", 2, $1, $3); }
-| expr PLUSEQ expr                                    { $$ = mk_node("ExprAssignAdd", 2, $1, $3); }
-| expr STAREQ expr                                    { $$ = mk_node("ExprAssignMul", 2, $1, $3); }
-| expr SLASHEQ expr                                   { $$ = mk_node("ExprAssignDiv", 2, $1, $3); }
-| expr CARETEQ expr                                   { $$ = mk_node("ExprAssignBitXor", 2, $1, $3); }
-| expr PERCENTEQ expr                                 { $$ = mk_node("ExprAssignRem", 2, $1, $3); }
-| expr OROR expr                                      { $$ = mk_node("ExprBinary", 3, mk_atom("BiOr"), $1, $3); }
-| expr ANDAND expr                                    { $$ = mk_node("ExprBinary", 3, mk_atom("BiAnd"), $1, $3); }
-| expr EQEQ expr                                      { $$ = mk_node("ExprBinary", 3, mk_atom("BiEq"), $1, $3); }
-| expr NE expr                                        { $$ = mk_node("ExprBinary", 3, mk_atom("BiNe"), $1, $3); }
-| expr '<' expr                                       { $$ = mk_node("ExprBinary", 3, mk_atom("BiLt"), $1, $3); }
-| expr '>' expr                                       { $$ = mk_node("ExprBinary", 3, mk_atom("BiGt"), $1, $3); }
-| expr LE expr                                        { $$ = mk_node("ExprBinary", 3, mk_atom("BiLe"), $1, $3); }
-| expr GE expr                                        { $$ = mk_node("ExprBinary", 3, mk_atom("BiGe"), $1, $3); }
-| expr '|' expr                                       { $$ = mk_node("ExprBinary", 3, mk_atom("BiBitOr"), $1, $3); }
-| expr '^' expr                                       { $$ = mk_node("ExprBinary", 3, mk_atom("BiBitXor"), $1, $3); }
-| expr '&' expr                                       { $$ = mk_node("ExprBinary", 3, mk_atom("BiBitAnd"), $1, $3); }
-| expr SHL expr                                       { $$ = mk_node("ExprBinary", 3, mk_atom("BiShl"), $1, $3); }
-| expr SHR expr                                       { $$ = mk_node("ExprBinary", 3, mk_atom("BiShr"), $1, $3); }
-| expr '+' expr                                       { $$ = mk_node("ExprBinary", 3, mk_atom("BiAdd"), $1, $3); }
-| expr '-' expr                                       { $$ = mk_node("ExprBinary", 3, mk_atom("BiSub"), $1, $3); }
-| expr '*' expr                                       { $$ = mk_node("ExprBinary", 3, mk_atom("BiMul"), $1, $3); }
-| expr '/' expr                                       { $$ = mk_node("ExprBinary", 3, mk_atom("BiDiv"), $1, $3); }
-| expr '%' expr                                       { $$ = mk_node("ExprBinary", 3, mk_atom("BiRem"), $1, $3); }
-| expr DOTDOT                                         { $$ = mk_node("ExprRange", 2, $1, mk_none()); }
-| expr DOTDOT expr                                    { $$ = mk_node("ExprRange", 2, $1, $3); }
-|      DOTDOT expr                                    { $$ = mk_node("ExprRange", 2, mk_none(), $2); }
-|      DOTDOT                                         { $$ = mk_node("ExprRange", 2, mk_none(), mk_none()); }
-| expr AS ty                                          { $$ = mk_node("ExprCast", 2, $1, $3); }
-| expr ':' ty                                         { $$ = mk_node("ExprTypeAscr", 2, $1, $3); }
-| BOX expr                                            { $$ = mk_node("ExprBox", 1, $2); }
+  path_expr                                           { $$ = mk_node(sess, NK_ExprPath, 1, $1); }
+| SELF                                                { $$ = mk_node(sess, NK_ExprPath, 1, mk_node(sess, NK_ident, 1, mk_atom(sess, "self"))); }
+| macro_expr                                          { $$ = mk_node(sess, NK_ExprMac, 1, $1); }
+| path_expr '{' struct_expr_fields '}'                { $$ = mk_node(sess, NK_ExprStruct, 2, $1, $3); }
+| expr '?'                                            { $$ = mk_node(sess, NK_ExprTry, 1, $1); }
+| expr '.' path_generic_args_with_colons              { $$ = mk_node(sess, NK_ExprField, 2, $1, $3); }
+| expr '.' LIT_INTEGER                                { $$ = mk_node(sess, NK_ExprTupleIndex, 1, $1); }
+| expr '[' maybe_expr ']'                             { $$ = mk_node(sess, NK_ExprIndex, 2, $1, $3); }
+| expr '(' maybe_exprs ')'                            { $$ = mk_node(sess, NK_ExprCall, 2, $1, $3); }
+| '(' maybe_exprs ')'                                 { $$ = mk_node(sess, NK_ExprParen, 1, $2); }
+| '[' vec_expr ']'                                    { $$ = mk_node(sess, NK_ExprVec, 1, $2); }
+| CONTINUE                                            { $$ = mk_node(sess, NK_ExprAgain, 0); }
+| CONTINUE ident                                      { $$ = mk_node(sess, NK_ExprAgain, 1, $2); }
+| RETURN                                              { $$ = mk_node(sess, NK_ExprRet, 0); }
+| RETURN expr                                         { $$ = mk_node(sess, NK_ExprRet, 1, $2); }
+| BREAK                                               { $$ = mk_node(sess, NK_ExprBreak, 0); }
+| BREAK ident                                         { $$ = mk_node(sess, NK_ExprBreak, 1, $2); }
+| YIELD                                               { $$ = mk_node(sess, NK_ExprYield, 0); }
+| YIELD expr                                          { $$ = mk_node(sess, NK_ExprYield, 1, $2); }
+| expr LARROW expr                                    { $$ = mk_node(sess, NK_ExprInPlace, 2, $1, $3); }
+| expr '=' expr                                       { $$ = mk_node(sess, NK_ExprAssign, 2, $1, $3); }
+| expr SHLEQ expr                                     { $$ = mk_node(sess, NK_ExprAssignShl, 2, $1, $3); }
+| expr SHREQ expr                                     { $$ = mk_node(sess, NK_ExprAssignShr, 2, $1, $3); }
+| expr MINUSEQ expr                                   { $$ = mk_node(sess, NK_ExprAssignSub, 2, $1, $3); }
+| expr ANDEQ expr                                     { $$ = mk_node(sess, NK_ExprAssignBitAnd, 2, $1, $3); }
+| expr OREQ expr                                      { $$ = mk_node(sess, NK_ExprAssignBitOr, 2, $1, $3); }
+| expr PLUSEQ expr                                    { $$ = mk_node(sess, NK_ExprAssignAdd, 2, $1, $3); }
+| expr STAREQ expr                                    { $$ = mk_node(sess, NK_ExprAssignMul, 2, $1, $3); }
+| expr SLASHEQ expr                                   { $$ = mk_node(sess, NK_ExprAssignDiv, 2, $1, $3); }
+| expr CARETEQ expr                                   { $$ = mk_node(sess, NK_ExprAssignBitXor, 2, $1, $3); }
+| expr PERCENTEQ expr                                 { $$ = mk_node(sess, NK_ExprAssignRem, 2, $1, $3); }
+| expr OROR expr                                      { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiOr"), $1, $3); }
+| expr ANDAND expr                                    { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiAnd"), $1, $3); }
+| expr EQEQ expr                                      { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiEq"), $1, $3); }
+| expr NE expr                                        { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiNe"), $1, $3); }
+| expr '<' expr                                       { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiLt"), $1, $3); }
+| expr '>' expr                                       { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiGt"), $1, $3); }
+| expr LE expr                                        { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiLe"), $1, $3); }
+| expr GE expr                                        { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiGe"), $1, $3); }
+| expr '|' expr                                       { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiBitOr"), $1, $3); }
+| expr '^' expr                                       { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiBitXor"), $1, $3); }
+| expr '&' expr                                       { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiBitAnd"), $1, $3); }
+| expr SHL expr                                       { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiShl"), $1, $3); }
+| expr SHR expr                                       { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiShr"), $1, $3); }
+| expr '+' expr                                       { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiAdd"), $1, $3); }
+| expr '-' expr                                       { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiSub"), $1, $3); }
+| expr '*' expr                                       { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiMul"), $1, $3); }
+| expr '/' expr                                       { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiDiv"), $1, $3); }
+| expr '%' expr                                       { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiRem"), $1, $3); }
+| expr DOTDOT                                         { $$ = mk_node(sess, NK_ExprRange, 2, $1, mk_none(sess)); }
+| expr DOTDOT expr                                    { $$ = mk_node(sess, NK_ExprRange, 2, $1, $3); }
+|      DOTDOT expr                                    { $$ = mk_node(sess, NK_ExprRange, 2, mk_none(sess), $2); }
+|      DOTDOT                                         { $$ = mk_node(sess, NK_ExprRange, 2, mk_none(sess), mk_none(sess)); }
+| expr AS ty                                          { $$ = mk_node(sess, NK_ExprCast, 2, $1, $3); }
+| expr ':' ty                                         { $$ = mk_node(sess, NK_ExprTypeAscr, 2, $1, $3); }
+| BOX expr                                            { $$ = mk_node(sess, NK_ExprBox, 1, $2); }
 | expr_qualified_path
 | block_expr
 | block
@@ -1507,63 +1557,63 @@ expr
 ;
 
 expr_nostruct
-: lit                                                 { $$ = mk_node("ExprLit", 1, $1); }
+: lit                                                 { $$ = mk_node(sess, NK_ExprLit, 1, $1); }
 | %prec IDENT
-  path_expr                                           { $$ = mk_node("ExprPath", 1, $1); }
-| SELF                                                { $$ = mk_node("ExprPath", 1, mk_node("ident", 1, mk_atom("self"))); }
-| macro_expr                                          { $$ = mk_node("ExprMac", 1, $1); }
-| expr_nostruct '?'                                   { $$ = mk_node("ExprTry", 1, $1); }
-| expr_nostruct '.' path_generic_args_with_colons     { $$ = mk_node("ExprField", 2, $1, $3); }
-| expr_nostruct '.' LIT_INTEGER                       { $$ = mk_node("ExprTupleIndex", 1, $1); }
-| expr_nostruct '[' maybe_expr ']'                    { $$ = mk_node("ExprIndex", 2, $1, $3); }
-| expr_nostruct '(' maybe_exprs ')'                   { $$ = mk_node("ExprCall", 2, $1, $3); }
-| '[' vec_expr ']'                                    { $$ = mk_node("ExprVec", 1, $2); }
-| '(' maybe_exprs ')'                                 { $$ = mk_node("ExprParen", 1, $2); }
-| CONTINUE                                            { $$ = mk_node("ExprAgain", 0); }
-| CONTINUE ident                                      { $$ = mk_node("ExprAgain", 1, $2); }
-| RETURN                                              { $$ = mk_node("ExprRet", 0); }
-| RETURN expr                                         { $$ = mk_node("ExprRet", 1, $2); }
-| BREAK                                               { $$ = mk_node("ExprBreak", 0); }
-| BREAK ident                                         { $$ = mk_node("ExprBreak", 1, $2); }
-| YIELD                                               { $$ = mk_node("ExprYield", 0); }
-| YIELD expr                                          { $$ = mk_node("ExprYield", 1, $2); }
-| expr_nostruct LARROW expr_nostruct                  { $$ = mk_node("ExprInPlace", 2, $1, $3); }
-| expr_nostruct '=' expr_nostruct                     { $$ = mk_node("ExprAssign", 2, $1, $3); }
-| expr_nostruct SHLEQ expr_nostruct                   { $$ = mk_node("ExprAssignShl", 2, $1, $3); }
-| expr_nostruct SHREQ expr_nostruct                   { $$ = mk_node("ExprAssignShr", 2, $1, $3); }
-| expr_nostruct MINUSEQ expr_nostruct                 { $$ = mk_node("ExprAssignSub", 2, $1, $3); }
-| expr_nostruct ANDEQ expr_nostruct                   { $$ = mk_node("ExprAssignBitAnd", 2, $1, $3); }
-| expr_nostruct OREQ expr_nostruct                    { $$ = mk_node("ExprAssignBitOr", 2, $1, $3); }
-| expr_nostruct PLUSEQ expr_nostruct                  { $$ = mk_node("ExprAssignAdd", 2, $1, $3); }
-| expr_nostruct STAREQ expr_nostruct                  { $$ = mk_node("ExprAssignMul", 2, $1, $3); }
-| expr_nostruct SLASHEQ expr_nostruct                 { $$ = mk_node("ExprAssignDiv", 2, $1, $3); }
-| expr_nostruct CARETEQ expr_nostruct                 { $$ = mk_node("ExprAssignBitXor", 2, $1, $3); }
-| expr_nostruct PERCENTEQ expr_nostruct               { $$ = mk_node("ExprAssignRem", 2, $1, $3); }
-| expr_nostruct OROR expr_nostruct                    { $$ = mk_node("ExprBinary", 3, mk_atom("BiOr"), $1, $3); }
-| expr_nostruct ANDAND expr_nostruct                  { $$ = mk_node("ExprBinary", 3, mk_atom("BiAnd"), $1, $3); }
-| expr_nostruct EQEQ expr_nostruct                    { $$ = mk_node("ExprBinary", 3, mk_atom("BiEq"), $1, $3); }
-| expr_nostruct NE expr_nostruct                      { $$ = mk_node("ExprBinary", 3, mk_atom("BiNe"), $1, $3); }
-| expr_nostruct '<' expr_nostruct                     { $$ = mk_node("ExprBinary", 3, mk_atom("BiLt"), $1, $3); }
-| expr_nostruct '>' expr_nostruct                     { $$ = mk_node("ExprBinary", 3, mk_atom("BiGt"), $1, $3); }
-| expr_nostruct LE expr_nostruct                      { $$ = mk_node("ExprBinary", 3, mk_atom("BiLe"), $1, $3); }
-| expr_nostruct GE expr_nostruct                      { $$ = mk_node("ExprBinary", 3, mk_atom("BiGe"), $1, $3); }
-| expr_nostruct '|' expr_nostruct                     { $$ = mk_node("ExprBinary", 3, mk_atom("BiBitOr"), $1, $3); }
-| expr_nostruct '^' expr_nostruct                     { $$ = mk_node("ExprBinary", 3, mk_atom("BiBitXor"), $1, $3); }
-| expr_nostruct '&' expr_nostruct                     { $$ = mk_node("ExprBinary", 3, mk_atom("BiBitAnd"), $1, $3); }
-| expr_nostruct SHL expr_nostruct                     { $$ = mk_node("ExprBinary", 3, mk_atom("BiShl"), $1, $3); }
-| expr_nostruct SHR expr_nostruct                     { $$ = mk_node("ExprBinary", 3, mk_atom("BiShr"), $1, $3); }
-| expr_nostruct '+' expr_nostruct                     { $$ = mk_node("ExprBinary", 3, mk_atom("BiAdd"), $1, $3); }
-| expr_nostruct '-' expr_nostruct                     { $$ = mk_node("ExprBinary", 3, mk_atom("BiSub"), $1, $3); }
-| expr_nostruct '*' expr_nostruct                     { $$ = mk_node("ExprBinary", 3, mk_atom("BiMul"), $1, $3); }
-| expr_nostruct '/' expr_nostruct                     { $$ = mk_node("ExprBinary", 3, mk_atom("BiDiv"), $1, $3); }
-| expr_nostruct '%' expr_nostruct                     { $$ = mk_node("ExprBinary", 3, mk_atom("BiRem"), $1, $3); }
-| expr_nostruct DOTDOT               %prec RANGE      { $$ = mk_node("ExprRange", 2, $1, mk_none()); }
-| expr_nostruct DOTDOT expr_nostruct                  { $$ = mk_node("ExprRange", 2, $1, $3); }
-|               DOTDOT expr_nostruct                  { $$ = mk_node("ExprRange", 2, mk_none(), $2); }
-|               DOTDOT                                { $$ = mk_node("ExprRange", 2, mk_none(), mk_none()); }
-| expr_nostruct AS ty                                 { $$ = mk_node("ExprCast", 2, $1, $3); }
-| expr_nostruct ':' ty                                { $$ = mk_node("ExprTypeAscr", 2, $1, $3); }
-| BOX expr                                            { $$ = mk_node("ExprBox", 1, $2); }
+  path_expr                                           { $$ = mk_node(sess, NK_ExprPath, 1, $1); }
+| SELF                                                { $$ = mk_node(sess, NK_ExprPath, 1, mk_node(sess, NK_ident, 1, mk_atom(sess, "self"))); }
+| macro_expr                                          { $$ = mk_node(sess, NK_ExprMac, 1, $1); }
+| expr_nostruct '?'                                   { $$ = mk_node(sess, NK_ExprTry, 1, $1); }
+| expr_nostruct '.' path_generic_args_with_colons     { $$ = mk_node(sess, NK_ExprField, 2, $1, $3); }
+| expr_nostruct '.' LIT_INTEGER                       { $$ = mk_node(sess, NK_ExprTupleIndex, 1, $1); }
+| expr_nostruct '[' maybe_expr ']'                    { $$ = mk_node(sess, NK_ExprIndex, 2, $1, $3); }
+| expr_nostruct '(' maybe_exprs ')'                   { $$ = mk_node(sess, NK_ExprCall, 2, $1, $3); }
+| '[' vec_expr ']'                                    { $$ = mk_node(sess, NK_ExprVec, 1, $2); }
+| '(' maybe_exprs ')'                                 { $$ = mk_node(sess, NK_ExprParen, 1, $2); }
+| CONTINUE                                            { $$ = mk_node(sess, NK_ExprAgain, 0); }
+| CONTINUE ident                                      { $$ = mk_node(sess, NK_ExprAgain, 1, $2); }
+| RETURN                                              { $$ = mk_node(sess, NK_ExprRet, 0); }
+| RETURN expr                                         { $$ = mk_node(sess, NK_ExprRet, 1, $2); }
+| BREAK                                               { $$ = mk_node(sess, NK_ExprBreak, 0); }
+| BREAK ident                                         { $$ = mk_node(sess, NK_ExprBreak, 1, $2); }
+| YIELD                                               { $$ = mk_node(sess, NK_ExprYield, 0); }
+| YIELD expr                                          { $$ = mk_node(sess, NK_ExprYield, 1, $2); }
+| expr_nostruct LARROW expr_nostruct                  { $$ = mk_node(sess, NK_ExprInPlace, 2, $1, $3); }
+| expr_nostruct '=' expr_nostruct                     { $$ = mk_node(sess, NK_ExprAssign, 2, $1, $3); }
+| expr_nostruct SHLEQ expr_nostruct                   { $$ = mk_node(sess, NK_ExprAssignShl, 2, $1, $3); }
+| expr_nostruct SHREQ expr_nostruct                   { $$ = mk_node(sess, NK_ExprAssignShr, 2, $1, $3); }
+| expr_nostruct MINUSEQ expr_nostruct                 { $$ = mk_node(sess, NK_ExprAssignSub, 2, $1, $3); }
+| expr_nostruct ANDEQ expr_nostruct                   { $$ = mk_node(sess, NK_ExprAssignBitAnd, 2, $1, $3); }
+| expr_nostruct OREQ expr_nostruct                    { $$ = mk_node(sess, NK_ExprAssignBitOr, 2, $1, $3); }
+| expr_nostruct PLUSEQ expr_nostruct                  { $$ = mk_node(sess, NK_ExprAssignAdd, 2, $1, $3); }
+| expr_nostruct STAREQ expr_nostruct                  { $$ = mk_node(sess, NK_ExprAssignMul, 2, $1, $3); }
+| expr_nostruct SLASHEQ expr_nostruct                 { $$ = mk_node(sess, NK_ExprAssignDiv, 2, $1, $3); }
+| expr_nostruct CARETEQ expr_nostruct                 { $$ = mk_node(sess, NK_ExprAssignBitXor, 2, $1, $3); }
+| expr_nostruct PERCENTEQ expr_nostruct               { $$ = mk_node(sess, NK_ExprAssignRem, 2, $1, $3); }
+| expr_nostruct OROR expr_nostruct                    { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiOr"), $1, $3); }
+| expr_nostruct ANDAND expr_nostruct                  { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiAnd"), $1, $3); }
+| expr_nostruct EQEQ expr_nostruct                    { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiEq"), $1, $3); }
+| expr_nostruct NE expr_nostruct                      { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiNe"), $1, $3); }
+| expr_nostruct '<' expr_nostruct                     { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiLt"), $1, $3); }
+| expr_nostruct '>' expr_nostruct                     { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiGt"), $1, $3); }
+| expr_nostruct LE expr_nostruct                      { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiLe"), $1, $3); }
+| expr_nostruct GE expr_nostruct                      { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiGe"), $1, $3); }
+| expr_nostruct '|' expr_nostruct                     { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiBitOr"), $1, $3); }
+| expr_nostruct '^' expr_nostruct                     { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiBitXor"), $1, $3); }
+| expr_nostruct '&' expr_nostruct                     { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiBitAnd"), $1, $3); }
+| expr_nostruct SHL expr_nostruct                     { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiShl"), $1, $3); }
+| expr_nostruct SHR expr_nostruct                     { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiShr"), $1, $3); }
+| expr_nostruct '+' expr_nostruct                     { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiAdd"), $1, $3); }
+| expr_nostruct '-' expr_nostruct                     { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiSub"), $1, $3); }
+| expr_nostruct '*' expr_nostruct                     { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiMul"), $1, $3); }
+| expr_nostruct '/' expr_nostruct                     { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiDiv"), $1, $3); }
+| expr_nostruct '%' expr_nostruct                     { $$ = mk_node(sess, NK_ExprBinary, 3, mk_atom(sess, "BiRem"), $1, $3); }
+| expr_nostruct DOTDOT               %prec RANGE      { $$ = mk_node(sess, NK_ExprRange, 2, $1, mk_none(sess)); }
+| expr_nostruct DOTDOT expr_nostruct                  { $$ = mk_node(sess, NK_ExprRange, 2, $1, $3); }
+|               DOTDOT expr_nostruct                  { $$ = mk_node(sess, NK_ExprRange, 2, mk_none(sess), $2); }
+|               DOTDOT                                { $$ = mk_node(sess, NK_ExprRange, 2, mk_none(sess), mk_none(sess)); }
+| expr_nostruct AS ty                                 { $$ = mk_node(sess, NK_ExprCast, 2, $1, $3); }
+| expr_nostruct ':' ty                                { $$ = mk_node(sess, NK_ExprTypeAscr, 2, $1, $3); }
+| BOX expr                                            { $$ = mk_node(sess, NK_ExprBox, 1, $2); }
 | expr_qualified_path
 | block_expr
 | block
@@ -1571,21 +1621,21 @@ expr_nostruct
 ;
 
 nonblock_prefix_expr_nostruct
-: '-' expr_nostruct                         { $$ = mk_node("ExprUnary", 2, mk_atom("UnNeg"), $2); }
-| '!' expr_nostruct                         { $$ = mk_node("ExprUnary", 2, mk_atom("UnNot"), $2); }
-| '*' expr_nostruct                         { $$ = mk_node("ExprUnary", 2, mk_atom("UnDeref"), $2); }
-| '&' maybe_mut expr_nostruct               { $$ = mk_node("ExprAddrOf", 2, $2, $3); }
-| ANDAND maybe_mut expr_nostruct            { $$ = mk_node("ExprAddrOf", 1, mk_node("ExprAddrOf", 2, $2, $3)); }
+: '-' expr_nostruct                         { $$ = mk_node(sess, NK_ExprUnary, 2, mk_atom(sess, "UnNeg"), $2); }
+| '!' expr_nostruct                         { $$ = mk_node(sess, NK_ExprUnary, 2, mk_atom(sess, "UnNot"), $2); }
+| '*' expr_nostruct                         { $$ = mk_node(sess, NK_ExprUnary, 2, mk_atom(sess, "UnDeref"), $2); }
+| '&' maybe_mut expr_nostruct               { $$ = mk_node(sess, NK_ExprAddrOf, 2, $2, $3); }
+| ANDAND maybe_mut expr_nostruct            { $$ = mk_node(sess, NK_ExprAddrOf, 1, mk_node(sess, NK_ExprAddrOf, 2, $2, $3)); }
 | lambda_expr_nostruct
 | MOVE lambda_expr_nostruct                 { $$ = $2; }
 ;
 
 nonblock_prefix_expr
-: '-' expr                         { $$ = mk_node("ExprUnary", 2, mk_atom("UnNeg"), $2); }
-| '!' expr                         { $$ = mk_node("ExprUnary", 2, mk_atom("UnNot"), $2); }
-| '*' expr                         { $$ = mk_node("ExprUnary", 2, mk_atom("UnDeref"), $2); }
-| '&' maybe_mut expr               { $$ = mk_node("ExprAddrOf", 2, $2, $3); }
-| ANDAND maybe_mut expr            { $$ = mk_node("ExprAddrOf", 1, mk_node("ExprAddrOf", 2, $2, $3)); }
+: '-' expr                         { $$ = mk_node(sess, NK_ExprUnary, 2, mk_atom(sess, "UnNeg"), $2); }
+| '!' expr                         { $$ = mk_node(sess, NK_ExprUnary, 2, mk_atom(sess, "UnNot"), $2); }
+| '*' expr                         { $$ = mk_node(sess, NK_ExprUnary, 2, mk_atom(sess, "UnDeref"), $2); }
+| '&' maybe_mut expr               { $$ = mk_node(sess, NK_ExprAddrOf, 2, $2, $3); }
+| ANDAND maybe_mut expr            { $$ = mk_node(sess, NK_ExprAddrOf, 1, mk_node(sess, NK_ExprAddrOf, 2, $2, $3)); }
 | lambda_expr
 | MOVE lambda_expr                 { $$ = $2; }
 ;
@@ -1593,106 +1643,106 @@ nonblock_prefix_expr
 expr_qualified_path
 : '<' ty_sum maybe_as_trait_ref '>' MOD_SEP ident maybe_qpath_params
 {
-  $$ = mk_node("ExprQualifiedPath", 4, $2, $3, $6, $7);
+  $$ = mk_node(sess, NK_ExprQualifiedPath, 4, $2, $3, $6, $7);
 }
 | SHL ty_sum maybe_as_trait_ref '>' MOD_SEP ident maybe_as_trait_ref '>' MOD_SEP ident
 {
-  $$ = mk_node("ExprQualifiedPath", 3, mk_node("ExprQualifiedPath", 3, $2, $3, $6), $7, $10);
+  $$ = mk_node(sess, NK_ExprQualifiedPath, 3, mk_node(sess, NK_ExprQualifiedPath, 3, $2, $3, $6), $7, $10);
 }
 | SHL ty_sum maybe_as_trait_ref '>' MOD_SEP ident generic_args maybe_as_trait_ref '>' MOD_SEP ident
 {
-  $$ = mk_node("ExprQualifiedPath", 3, mk_node("ExprQualifiedPath", 4, $2, $3, $6, $7), $8, $11);
+  $$ = mk_node(sess, NK_ExprQualifiedPath, 3, mk_node(sess, NK_ExprQualifiedPath, 4, $2, $3, $6, $7), $8, $11);
 }
 | SHL ty_sum maybe_as_trait_ref '>' MOD_SEP ident maybe_as_trait_ref '>' MOD_SEP ident generic_args
 {
-  $$ = mk_node("ExprQualifiedPath", 4, mk_node("ExprQualifiedPath", 3, $2, $3, $6), $7, $10, $11);
+  $$ = mk_node(sess, NK_ExprQualifiedPath, 4, mk_node(sess, NK_ExprQualifiedPath, 3, $2, $3, $6), $7, $10, $11);
 }
 | SHL ty_sum maybe_as_trait_ref '>' MOD_SEP ident generic_args maybe_as_trait_ref '>' MOD_SEP ident generic_args
 {
-  $$ = mk_node("ExprQualifiedPath", 4, mk_node("ExprQualifiedPath", 4, $2, $3, $6, $7), $8, $11, $12);
+  $$ = mk_node(sess, NK_ExprQualifiedPath, 4, mk_node(sess, NK_ExprQualifiedPath, 4, $2, $3, $6, $7), $8, $11, $12);
 }
 
 maybe_qpath_params
 : MOD_SEP generic_args { $$ = $2; }
-| %empty               { $$ = mk_none(); }
+| %empty               { $$ = mk_none(sess); }
 ;
 
 maybe_as_trait_ref
 : AS trait_ref { $$ = $2; }
-| %empty       { $$ = mk_none(); }
+| %empty       { $$ = mk_none(sess); }
 ;
 
 lambda_expr
 : %prec LAMBDA
-  OROR ret_ty expr                                    { $$ = mk_node("ExprFnBlock", 3, mk_none(), $2, $3); }
+  OROR ret_ty expr                                    { $$ = mk_node(sess, NK_ExprFnBlock, 3, mk_none(sess), $2, $3); }
 | %prec LAMBDA
-  '|' '|' ret_ty expr                                 { $$ = mk_node("ExprFnBlock", 3, mk_none(), $3, $4); }
+  '|' '|' ret_ty expr                                 { $$ = mk_node(sess, NK_ExprFnBlock, 3, mk_none(sess), $3, $4); }
 | %prec LAMBDA
-  '|' inferrable_params '|' ret_ty expr               { $$ = mk_node("ExprFnBlock", 3, $2, $4, $5); }
+  '|' inferrable_params '|' ret_ty expr               { $$ = mk_node(sess, NK_ExprFnBlock, 3, $2, $4, $5); }
 | %prec LAMBDA
-  '|' inferrable_params OROR lambda_expr_no_first_bar { $$ = mk_node("ExprFnBlock", 3, $2, mk_none(), $4); }
+  '|' inferrable_params OROR lambda_expr_no_first_bar { $$ = mk_node(sess, NK_ExprFnBlock, 3, $2, mk_none(sess), $4); }
 ;
 
 lambda_expr_no_first_bar
 : %prec LAMBDA
-  '|' ret_ty expr                                 { $$ = mk_node("ExprFnBlock", 3, mk_none(), $2, $3); }
+  '|' ret_ty expr                                 { $$ = mk_node(sess, NK_ExprFnBlock, 3, mk_none(sess), $2, $3); }
 | %prec LAMBDA
-  inferrable_params '|' ret_ty expr               { $$ = mk_node("ExprFnBlock", 3, $1, $3, $4); }
+  inferrable_params '|' ret_ty expr               { $$ = mk_node(sess, NK_ExprFnBlock, 3, $1, $3, $4); }
 | %prec LAMBDA
-  inferrable_params OROR lambda_expr_no_first_bar { $$ = mk_node("ExprFnBlock", 3, $1, mk_none(), $3); }
+  inferrable_params OROR lambda_expr_no_first_bar { $$ = mk_node(sess, NK_ExprFnBlock, 3, $1, mk_none(sess), $3); }
 ;
 
 lambda_expr_nostruct
 : %prec LAMBDA
-  OROR expr_nostruct                                           { $$ = mk_node("ExprFnBlock", 2, mk_none(), $2); }
+  OROR expr_nostruct                                           { $$ = mk_node(sess, NK_ExprFnBlock, 2, mk_none(sess), $2); }
 | %prec LAMBDA
-  '|' '|' ret_ty expr_nostruct                                 { $$ = mk_node("ExprFnBlock", 3, mk_none(), $3, $4); }
+  '|' '|' ret_ty expr_nostruct                                 { $$ = mk_node(sess, NK_ExprFnBlock, 3, mk_none(sess), $3, $4); }
 | %prec LAMBDA
-  '|' inferrable_params '|' expr_nostruct                      { $$ = mk_node("ExprFnBlock", 2, $2, $4); }
+  '|' inferrable_params '|' expr_nostruct                      { $$ = mk_node(sess, NK_ExprFnBlock, 2, $2, $4); }
 | %prec LAMBDA
-  '|' inferrable_params OROR lambda_expr_nostruct_no_first_bar { $$ = mk_node("ExprFnBlock", 3, $2, mk_none(), $4); }
+  '|' inferrable_params OROR lambda_expr_nostruct_no_first_bar { $$ = mk_node(sess, NK_ExprFnBlock, 3, $2, mk_none(sess), $4); }
 ;
 
 lambda_expr_nostruct_no_first_bar
 : %prec LAMBDA
-  '|' ret_ty expr_nostruct                                 { $$ = mk_node("ExprFnBlock", 3, mk_none(), $2, $3); }
+  '|' ret_ty expr_nostruct                                 { $$ = mk_node(sess, NK_ExprFnBlock, 3, mk_none(sess), $2, $3); }
 | %prec LAMBDA
-  inferrable_params '|' ret_ty expr_nostruct               { $$ = mk_node("ExprFnBlock", 3, $1, $3, $4); }
+  inferrable_params '|' ret_ty expr_nostruct               { $$ = mk_node(sess, NK_ExprFnBlock, 3, $1, $3, $4); }
 | %prec LAMBDA
-  inferrable_params OROR lambda_expr_nostruct_no_first_bar { $$ = mk_node("ExprFnBlock", 3, $1, mk_none(), $3); }
+  inferrable_params OROR lambda_expr_nostruct_no_first_bar { $$ = mk_node(sess, NK_ExprFnBlock, 3, $1, mk_none(sess), $3); }
 ;
 
 vec_expr
 : maybe_exprs
-| exprs ';' expr { $$ = mk_node("VecRepeat", 2, $1, $3); }
+| exprs ';' expr { $$ = mk_node(sess, NK_VecRepeat, 2, $1, $3); }
 ;
 
 struct_expr_fields
 : field_inits
 | field_inits ','
-| maybe_field_inits default_field_init { $$ = ext_node($1, 1, $2); }
-| %empty                               { $$ = mk_none(); }
+| maybe_field_inits default_field_init { $$ = ext_node(sess, $1, 1, $2); }
+| %empty                               { $$ = mk_none(sess); }
 ;
 
 maybe_field_inits
 : field_inits
 | field_inits ','
-| %empty { $$ = mk_none(); }
+| %empty { $$ = mk_none(sess); }
 ;
 
 field_inits
-: field_init                 { $$ = mk_node("FieldInits", 1, $1); }
-| field_inits ',' field_init { $$ = ext_node($1, 1, $3); }
+: field_init                 { $$ = mk_node(sess, NK_FieldInits, 1, $1); }
+| field_inits ',' field_init { $$ = ext_node(sess, $1, 1, $3); }
 ;
 
 field_init
-: ident                { $$ = mk_node("FieldInit", 1, $1); }
-| ident ':' expr       { $$ = mk_node("FieldInit", 2, $1, $3); }
-| LIT_INTEGER ':' expr { $$ = mk_node("FieldInit", 2, mk_atom(yytext), $3); }
+: ident                { $$ = mk_node(sess, NK_FieldInit, 1, $1); }
+| ident ':' expr       { $$ = mk_node(sess, NK_FieldInit, 2, $1, $3); }
+| LIT_INTEGER ':' expr { $$ = mk_node(sess, NK_FieldInit, 2, mk_atom(sess, yytext), $3); }
 ;
 
 default_field_init
-: DOTDOT expr   { $$ = mk_node("DefaultFieldInit", 1, $2); }
+: DOTDOT expr   { $$ = mk_node(sess, NK_DefaultFieldInit, 1, $2); }
 ;
 
 block_expr
@@ -1703,8 +1753,8 @@ block_expr
 | expr_while_let
 | expr_loop
 | expr_for
-| UNSAFE block                                           { $$ = mk_node("UnsafeBlock", 1, $2); }
-| path_expr '!' maybe_ident braces_delimited_token_trees { $$ = mk_node("Macro", 3, $1, $3, $4); }
+| UNSAFE block                                           { $$ = mk_node(sess, NK_UnsafeBlock, 1, $2); }
+| path_expr '!' maybe_ident braces_delimited_token_trees { $$ = mk_node(sess, NK_Macro, 3, $1, $3, $4); }
 ;
 
 full_block_expr
@@ -1713,26 +1763,26 @@ full_block_expr
 ;
 
 block_expr_dot
-: block_expr     '.' path_generic_args_with_colons %prec IDENT         { $$ = mk_node("ExprField", 2, $1, $3); }
-| block_expr_dot '.' path_generic_args_with_colons %prec IDENT         { $$ = mk_node("ExprField", 2, $1, $3); }
-| block_expr     '.' path_generic_args_with_colons '[' maybe_expr ']'  { $$ = mk_node("ExprIndex", 3, $1, $3, $5); }
-| block_expr_dot '.' path_generic_args_with_colons '[' maybe_expr ']'  { $$ = mk_node("ExprIndex", 3, $1, $3, $5); }
-| block_expr     '.' path_generic_args_with_colons '(' maybe_exprs ')' { $$ = mk_node("ExprCall", 3, $1, $3, $5); }
-| block_expr_dot '.' path_generic_args_with_colons '(' maybe_exprs ')' { $$ = mk_node("ExprCall", 3, $1, $3, $5); }
-| block_expr     '.' LIT_INTEGER                                       { $$ = mk_node("ExprTupleIndex", 1, $1); }
-| block_expr_dot '.' LIT_INTEGER                                       { $$ = mk_node("ExprTupleIndex", 1, $1); }
+: block_expr     '.' path_generic_args_with_colons %prec IDENT         { $$ = mk_node(sess, NK_ExprField, 2, $1, $3); }
+| block_expr_dot '.' path_generic_args_with_colons %prec IDENT         { $$ = mk_node(sess, NK_ExprField, 2, $1, $3); }
+| block_expr     '.' path_generic_args_with_colons '[' maybe_expr ']'  { $$ = mk_node(sess, NK_ExprIndex, 3, $1, $3, $5); }
+| block_expr_dot '.' path_generic_args_with_colons '[' maybe_expr ']'  { $$ = mk_node(sess, NK_ExprIndex, 3, $1, $3, $5); }
+| block_expr     '.' path_generic_args_with_colons '(' maybe_exprs ')' { $$ = mk_node(sess, NK_ExprCall, 3, $1, $3, $5); }
+| block_expr_dot '.' path_generic_args_with_colons '(' maybe_exprs ')' { $$ = mk_node(sess, NK_ExprCall, 3, $1, $3, $5); }
+| block_expr     '.' LIT_INTEGER                                       { $$ = mk_node(sess, NK_ExprTupleIndex, 1, $1); }
+| block_expr_dot '.' LIT_INTEGER                                       { $$ = mk_node(sess, NK_ExprTupleIndex, 1, $1); }
 ;
 
 expr_match
-: MATCH expr_nostruct '{' '}'                                     { $$ = mk_node("ExprMatch", 1, $2); }
-| MATCH expr_nostruct '{' match_clauses                       '}' { $$ = mk_node("ExprMatch", 2, $2, $4); }
-| MATCH expr_nostruct '{' match_clauses nonblock_match_clause '}' { $$ = mk_node("ExprMatch", 2, $2, ext_node($4, 1, $5)); }
-| MATCH expr_nostruct '{'               nonblock_match_clause '}' { $$ = mk_node("ExprMatch", 2, $2, mk_node("Arms", 1, $4)); }
+: MATCH expr_nostruct '{' '}'                                     { $$ = mk_node(sess, NK_ExprMatch, 1, $2); }
+| MATCH expr_nostruct '{' match_clauses                       '}' { $$ = mk_node(sess, NK_ExprMatch, 2, $2, $4); }
+| MATCH expr_nostruct '{' match_clauses nonblock_match_clause '}' { $$ = mk_node(sess, NK_ExprMatch, 2, $2, ext_node(sess, $4, 1, $5)); }
+| MATCH expr_nostruct '{'               nonblock_match_clause '}' { $$ = mk_node(sess, NK_ExprMatch, 2, $2, mk_node(sess, NK_Arms, 1, $4)); }
 ;
 
 match_clauses
-: match_clause               { $$ = mk_node("Arms", 1, $1); }
-| match_clauses match_clause { $$ = ext_node($1, 1, $2); }
+: match_clause               { $$ = mk_node(sess, NK_Arms, 1, $1); }
+| match_clauses match_clause { $$ = ext_node(sess, $1, 1, $2); }
 ;
 
 match_clause
@@ -1742,28 +1792,28 @@ match_clause
 ;
 
 nonblock_match_clause
-: maybe_outer_attrs pats_or maybe_guard FAT_ARROW nonblock_expr  { $$ = mk_node("ArmNonblock", 4, $1, $2, $3, $5); }
-| maybe_outer_attrs pats_or maybe_guard FAT_ARROW block_expr_dot { $$ = mk_node("ArmNonblock", 4, $1, $2, $3, $5); }
+: maybe_outer_attrs pats_or maybe_guard FAT_ARROW nonblock_expr  { $$ = mk_node(sess, NK_ArmNonblock, 4, $1, $2, $3, $5); }
+| maybe_outer_attrs pats_or maybe_guard FAT_ARROW block_expr_dot { $$ = mk_node(sess, NK_ArmNonblock, 4, $1, $2, $3, $5); }
 ;
 
 block_match_clause
-: maybe_outer_attrs pats_or maybe_guard FAT_ARROW block      { $$ = mk_node("ArmBlock", 4, $1, $2, $3, $5); }
-| maybe_outer_attrs pats_or maybe_guard FAT_ARROW block_expr { $$ = mk_node("ArmBlock", 4, $1, $2, $3, $5); }
+: maybe_outer_attrs pats_or maybe_guard FAT_ARROW block      { $$ = mk_node(sess, NK_ArmBlock, 4, $1, $2, $3, $5); }
+| maybe_outer_attrs pats_or maybe_guard FAT_ARROW block_expr { $$ = mk_node(sess, NK_ArmBlock, 4, $1, $2, $3, $5); }
 ;
 
 maybe_guard
 : IF expr_nostruct           { $$ = $2; }
-| %empty                     { $$ = mk_none(); }
+| %empty                     { $$ = mk_none(sess); }
 ;
 
 expr_if
-: IF expr_nostruct block                              { $$ = mk_node("ExprIf", 2, $2, $3); }
-| IF expr_nostruct block ELSE block_or_if             { $$ = mk_node("ExprIf", 3, $2, $3, $5); }
+: IF expr_nostruct block                              { $$ = mk_node(sess, NK_ExprIf, 2, $2, $3); }
+| IF expr_nostruct block ELSE block_or_if             { $$ = mk_node(sess, NK_ExprIf, 3, $2, $3, $5); }
 ;
 
 expr_if_let
-: IF LET pat '=' expr_nostruct block                  { $$ = mk_node("ExprIfLet", 3, $3, $5, $6); }
-| IF LET pat '=' expr_nostruct block ELSE block_or_if { $$ = mk_node("ExprIfLet", 4, $3, $5, $6, $8); }
+: IF LET pat '=' expr_nostruct block                  { $$ = mk_node(sess, NK_ExprIfLet, 3, $3, $5, $6); }
+| IF LET pat '=' expr_nostruct block ELSE block_or_if { $$ = mk_node(sess, NK_ExprIfLet, 4, $3, $5, $6, $8); }
 ;
 
 block_or_if
@@ -1773,28 +1823,28 @@ block_or_if
 ;
 
 expr_while
-: maybe_label WHILE expr_nostruct block               { $$ = mk_node("ExprWhile", 3, $1, $3, $4); }
+: maybe_label WHILE expr_nostruct block               { $$ = mk_node(sess, NK_ExprWhile, 3, $1, $3, $4); }
 ;
 
 expr_while_let
-: maybe_label WHILE LET pat '=' expr_nostruct block   { $$ = mk_node("ExprWhileLet", 4, $1, $4, $6, $7); }
+: maybe_label WHILE LET pat '=' expr_nostruct block   { $$ = mk_node(sess, NK_ExprWhileLet, 4, $1, $4, $6, $7); }
 ;
 
 expr_loop
-: maybe_label LOOP block                              { $$ = mk_node("ExprLoop", 2, $1, $3); }
+: maybe_label LOOP block                              { $$ = mk_node(sess, NK_ExprLoop, 2, $1, $3); }
 ;
 
 expr_for
-: maybe_label FOR pat IN expr_nostruct block          { $$ = mk_node("ExprForLoop", 4, $1, $3, $5, $6); }
+: maybe_label FOR pat IN expr_nostruct block          { $$ = mk_node(sess, NK_ExprForLoop, 4, $1, $3, $5, $6); }
 ;
 
 maybe_label
 : lifetime ':'
-| %empty { $$ = mk_none(); }
+| %empty { $$ = mk_none(sess); }
 ;
 
 let
-: LET pat maybe_ty_ascription maybe_init_expr ';' { $$ = mk_node("DeclLocal", 3, $2, $3, $4); }
+: LET pat maybe_ty_ascription maybe_init_expr ';' { $$ = mk_node(sess, NK_DeclLocal, 3, $2, $3, $4); }
 ;
 
 ////////////////////////////////////////////////////////////////////////
@@ -1802,160 +1852,160 @@ let
 ////////////////////////////////////////////////////////////////////////
 
 lit
-: LIT_BYTE                   { $$ = mk_node("LitByte", 1, mk_atom(yytext)); }
-| LIT_CHAR                   { $$ = mk_node("LitChar", 1, mk_atom(yytext)); }
-| LIT_INTEGER                { $$ = mk_node("LitInteger", 1, mk_atom(yytext)); }
-| LIT_FLOAT                  { $$ = mk_node("LitFloat", 1, mk_atom(yytext)); }
-| TRUE                       { $$ = mk_node("LitBool", 1, mk_atom(yytext)); }
-| FALSE                      { $$ = mk_node("LitBool", 1, mk_atom(yytext)); }
+: LIT_BYTE                   { $$ = mk_node(sess, NK_LitByte, 1, mk_atom(sess, yytext)); }
+| LIT_CHAR                   { $$ = mk_node(sess, NK_LitChar, 1, mk_atom(sess, yytext)); }
+| LIT_INTEGER                { $$ = with_int_lit(sess, mk_node(sess, NK_LitInteger, 1, mk_atom(sess, yytext))); }
+| LIT_FLOAT                  { $$ = mk_node(sess, NK_LitFloat, 1, mk_atom(sess, yytext)); }
+| TRUE                       { $$ = mk_node(sess, NK_LitBool, 1, mk_atom(sess, yytext)); }
+| FALSE                      { $$ = mk_node(sess, NK_LitBool, 1, mk_atom(sess, yytext)); }
 | str
 ;
 
 str
-: LIT_STR                    { $$ = mk_node("LitStr", 1, mk_atom(yytext), mk_atom("CookedStr")); }
-| LIT_STR_RAW                { $$ = mk_node("LitStr", 1, mk_atom(yytext), mk_atom("RawStr")); }
-| LIT_BYTE_STR                 { $$ = mk_node("LitByteStr", 1, mk_atom(yytext), mk_atom("ByteStr")); }
-| LIT_BYTE_STR_RAW             { $$ = mk_node("LitByteStr", 1, mk_atom(yytext), mk_atom("RawByteStr")); }
+: LIT_STR                    { $$ = mk_node(sess, NK_LitStr, 1, mk_atom(sess, yytext), mk_atom(sess, "CookedStr")); }
+| LIT_STR_RAW                { $$ = mk_node(sess, NK_LitStr, 1, mk_atom(sess, yytext), mk_atom(sess, "RawStr")); }
+| LIT_BYTE_STR                 { $$ = mk_node(sess, NK_LitByteStr, 1, mk_atom(sess, yytext), mk_atom(sess, "ByteStr")); }
+| LIT_BYTE_STR_RAW             { $$ = mk_node(sess, NK_LitByteStr, 1, mk_atom(sess, yytext), mk_atom(sess, "RawByteStr")); }
 ;
 
 maybe_ident
-: %empty { $$ = mk_none(); }
+: %empty { $$ = mk_none(sess); }
 | ident
 ;
 
 ident
-: IDENT                      { $$ = mk_node("ident", 1, mk_atom(yytext)); }
+: IDENT                      { $$ = mk_node(sess, NK_ident, 1, mk_atom(sess, yytext)); }
 // Weak keywords that can be used as identifiers
-| CATCH                      { $$ = mk_node("ident", 1, mk_atom(yytext)); }
-| DEFAULT                    { $$ = mk_node("ident", 1, mk_atom(yytext)); }
-| UNION                      { $$ = mk_node("ident", 1, mk_atom(yytext)); }
+| CATCH                      { $$ = mk_node(sess, NK_ident, 1, mk_atom(sess, yytext)); }
+| DEFAULT                    { $$ = mk_node(sess, NK_ident, 1, mk_atom(sess, yytext)); }
+| UNION                      { $$ = mk_node(sess, NK_ident, 1, mk_atom(sess, yytext)); }
 ;
 
 unpaired_token
-: SHL                        { $$ = mk_atom(yytext); }
-| SHR                        { $$ = mk_atom(yytext); }
-| LE                         { $$ = mk_atom(yytext); }
-| EQEQ                       { $$ = mk_atom(yytext); }
-| NE                         { $$ = mk_atom(yytext); }
-| GE                         { $$ = mk_atom(yytext); }
-| ANDAND                     { $$ = mk_atom(yytext); }
-| OROR                       { $$ = mk_atom(yytext); }
-| LARROW                     { $$ = mk_atom(yytext); }
-| SHLEQ                      { $$ = mk_atom(yytext); }
-| SHREQ                      { $$ = mk_atom(yytext); }
-| MINUSEQ                    { $$ = mk_atom(yytext); }
-| ANDEQ                      { $$ = mk_atom(yytext); }
-| OREQ                       { $$ = mk_atom(yytext); }
-| PLUSEQ                     { $$ = mk_atom(yytext); }
-| STAREQ                     { $$ = mk_atom(yytext); }
-| SLASHEQ                    { $$ = mk_atom(yytext); }
-| CARETEQ                    { $$ = mk_atom(yytext); }
-| PERCENTEQ                  { $$ = mk_atom(yytext); }
-| DOTDOT                     { $$ = mk_atom(yytext); }
-| DOTDOTDOT                  { $$ = mk_atom(yytext); }
-| MOD_SEP                    { $$ = mk_atom(yytext); }
-| RARROW                     { $$ = mk_atom(yytext); }
-| FAT_ARROW                  { $$ = mk_atom(yytext); }
-| LIT_BYTE                   { $$ = mk_atom(yytext); }
-| LIT_CHAR                   { $$ = mk_atom(yytext); }
-| LIT_INTEGER                { $$ = mk_atom(yytext); }
-| LIT_FLOAT                  { $$ = mk_atom(yytext); }
-| LIT_STR                    { $$ = mk_atom(yytext); }
-| LIT_STR_RAW                { $$ = mk_atom(yytext); }
-| LIT_BYTE_STR               { $$ = mk_atom(yytext); }
-| LIT_BYTE_STR_RAW           { $$ = mk_atom(yytext); }
-| IDENT                      { $$ = mk_atom(yytext); }
-| UNDERSCORE                 { $$ = mk_atom(yytext); }
-| LIFETIME                   { $$ = mk_atom(yytext); }
-| SELF                       { $$ = mk_atom(yytext); }
-| STATIC                     { $$ = mk_atom(yytext); }
-| ABSTRACT                   { $$ = mk_atom(yytext); }
-| ALIGNOF                    { $$ = mk_atom(yytext); }
-| AS                         { $$ = mk_atom(yytext); }
-| BECOME                     { $$ = mk_atom(yytext); }
-| BREAK                      { $$ = mk_atom(yytext); }
-| CATCH                      { $$ = mk_atom(yytext); }
-| CRATE                      { $$ = mk_atom(yytext); }
-| DEFAULT                    { $$ = mk_atom(yytext); }
-| DO                         { $$ = mk_atom(yytext); }
-| ELSE                       { $$ = mk_atom(yytext); }
-| ENUM                       { $$ = mk_atom(yytext); }
-| EXTERN                     { $$ = mk_atom(yytext); }
-| FALSE                      { $$ = mk_atom(yytext); }
-| FINAL                      { $$ = mk_atom(yytext); }
-| FN                         { $$ = mk_atom(yytext); }
-| FOR                        { $$ = mk_atom(yytext); }
-| IF                         { $$ = mk_atom(yytext); }
-| IMPL                       { $$ = mk_atom(yytext); }
-| IN                         { $$ = mk_atom(yytext); }
-| LET                        { $$ = mk_atom(yytext); }
-| LOOP                       { $$ = mk_atom(yytext); }
-| MACRO                      { $$ = mk_atom(yytext); }
-| MATCH                      { $$ = mk_atom(yytext); }
-| MOD                        { $$ = mk_atom(yytext); }
-| MOVE                       { $$ = mk_atom(yytext); }
-| MUT                        { $$ = mk_atom(yytext); }
-| OFFSETOF                   { $$ = mk_atom(yytext); }
-| OVERRIDE                   { $$ = mk_atom(yytext); }
-| PRIV                       { $$ = mk_atom(yytext); }
-| PUB                        { $$ = mk_atom(yytext); }
-| PURE                       { $$ = mk_atom(yytext); }
-| REF                        { $$ = mk_atom(yytext); }
-| RETURN                     { $$ = mk_atom(yytext); }
-| STRUCT                     { $$ = mk_atom(yytext); }
-| SIZEOF                     { $$ = mk_atom(yytext); }
-| SUPER                      { $$ = mk_atom(yytext); }
-| TRUE                       { $$ = mk_atom(yytext); }
-| TRAIT                      { $$ = mk_atom(yytext); }
-| TYPE                       { $$ = mk_atom(yytext); }
-| UNION                      { $$ = mk_atom(yytext); }
-| UNSAFE                     { $$ = mk_atom(yytext); }
-| UNSIZED                    { $$ = mk_atom(yytext); }
-| USE                        { $$ = mk_atom(yytext); }
-| VIRTUAL                    { $$ = mk_atom(yytext); }
-| WHILE                      { $$ = mk_atom(yytext); }
-| YIELD                      { $$ = mk_atom(yytext); }
-| CONTINUE                   { $$ = mk_atom(yytext); }
-| PROC                       { $$ = mk_atom(yytext); }
-| BOX                        { $$ = mk_atom(yytext); }
-| CONST                      { $$ = mk_atom(yytext); }
-| WHERE                      { $$ = mk_atom(yytext); }
-| TYPEOF                     { $$ = mk_atom(yytext); }
-| INNER_DOC_COMMENT          { $$ = mk_atom(yytext); }
-| OUTER_DOC_COMMENT          { $$ = mk_atom(yytext); }
-| SHEBANG                    { $$ = mk_atom(yytext); }
-| STATIC_LIFETIME            { $$ = mk_atom(yytext); }
-| ';'                        { $$ = mk_atom(yytext); }
-| ','                        { $$ = mk_atom(yytext); }
-| '.'                        { $$ = mk_atom(yytext); }
-| '@'                        { $$ = mk_atom(yytext); }
-| '#'                        { $$ = mk_atom(yytext); }
-| '~'                        { $$ = mk_atom(yytext); }
-| ':'                        { $$ = mk_atom(yytext); }
-| '$'                        { $$ = mk_atom(yytext); }
-| '='                        { $$ = mk_atom(yytext); }
-| '?'                        { $$ = mk_atom(yytext); }
-| '!'                        { $$ = mk_atom(yytext); }
-| '<'                        { $$ = mk_atom(yytext); }
-| '>'                        { $$ = mk_atom(yytext); }
-| '-'                        { $$ = mk_atom(yytext); }
-| '&'                        { $$ = mk_atom(yytext); }
-| '|'                        { $$ = mk_atom(yytext); }
-| '+'                        { $$ = mk_atom(yytext); }
-| '*'                        { $$ = mk_atom(yytext); }
-| '/'                        { $$ = mk_atom(yytext); }
-| '^'                        { $$ = mk_atom(yytext); }
-| '%'                        { $$ = mk_atom(yytext); }
+: SHL                        { $$ = mk_token(sess, yytext); }
+| SHR                        { $$ = mk_token(sess, yytext); }
+| LE                         { $$ = mk_token(sess, yytext); }
+| EQEQ                       { $$ = mk_token(sess, yytext); }
+| NE                         { $$ = mk_token(sess, yytext); }
+| GE                         { $$ = mk_token(sess, yytext); }
+| ANDAND                     { $$ = mk_token(sess, yytext); }
+| OROR                       { $$ = mk_token(sess, yytext); }
+| LARROW                     { $$ = mk_token(sess, yytext); }
+| SHLEQ                      { $$ = mk_token(sess, yytext); }
+| SHREQ                      { $$ = mk_token(sess, yytext); }
+| MINUSEQ                    { $$ = mk_token(sess, yytext); }
+| ANDEQ                      { $$ = mk_token(sess, yytext); }
+| OREQ                       { $$ = mk_token(sess, yytext); }
+| PLUSEQ                     { $$ = mk_token(sess, yytext); }
+| STAREQ                     { $$ = mk_token(sess, yytext); }
+| SLASHEQ                    { $$ = mk_token(sess, yytext); }
+| CARETEQ                    { $$ = mk_token(sess, yytext); }
+| PERCENTEQ                  { $$ = mk_token(sess, yytext); }
+| DOTDOT                     { $$ = mk_token(sess, yytext); }
+| DOTDOTDOT                  { $$ = mk_token(sess, yytext); }
+| MOD_SEP                    { $$ = mk_token(sess, yytext); }
+| RARROW                     { $$ = mk_token(sess, yytext); }
+| FAT_ARROW                  { $$ = mk_token(sess, yytext); }
+| LIT_BYTE                   { $$ = mk_token(sess, yytext); }
+| LIT_CHAR                   { $$ = mk_token(sess, yytext); }
+| LIT_INTEGER                { $$ = mk_token(sess, yytext); }
+| LIT_FLOAT                  { $$ = mk_token(sess, yytext); }
+| LIT_STR                    { $$ = mk_token(sess, yytext); }
+| LIT_STR_RAW                { $$ = mk_token(sess, yytext); }
+| LIT_BYTE_STR               { $$ = mk_token(sess, yytext); }
+| LIT_BYTE_STR_RAW           { $$ = mk_token(sess, yytext); }
+| IDENT                      { $$ = mk_token(sess, yytext); }
+| UNDERSCORE                 { $$ = mk_token(sess, yytext); }
+| LIFETIME                   { $$ = mk_token(sess, yytext); }
+| SELF                       { $$ = mk_token(sess, yytext); }
+| STATIC                     { $$ = mk_token(sess, yytext); }
+| ABSTRACT                   { $$ = mk_token(sess, yytext); }
+| ALIGNOF                    { $$ = mk_token(sess, yytext); }
+| AS                         { $$ = mk_token(sess, yytext); }
+| BECOME                     { $$ = mk_token(sess, yytext); }
+| BREAK                      { $$ = mk_token(sess, yytext); }
+| CATCH                      { $$ = mk_token(sess, yytext); }
+| CRATE                      { $$ = mk_token(sess, yytext); }
+| DEFAULT                    { $$ = mk_token(sess, yytext); }
+| DO                         { $$ = mk_token(sess, yytext); }
+| ELSE                       { $$ = mk_token(sess, yytext); }
+| ENUM                       { $$ = mk_token(sess, yytext); }
+| EXTERN                     { $$ = mk_token(sess, yytext); }
+| FALSE                      { $$ = mk_token(sess, yytext); }
+| FINAL                      { $$ = mk_token(sess, yytext); }
+| FN                         { $$ = mk_token(sess, yytext); }
+| FOR                        { $$ = mk_token(sess, yytext); }
+| IF                         { $$ = mk_token(sess, yytext); }
+| IMPL                       { $$ = mk_token(sess, yytext); }
+| IN                         { $$ = mk_token(sess, yytext); }
+| LET                        { $$ = mk_token(sess, yytext); }
+| LOOP                       { $$ = mk_token(sess, yytext); }
+| MACRO                      { $$ = mk_token(sess, yytext); }
+| MATCH                      { $$ = mk_token(sess, yytext); }
+| MOD                        { $$ = mk_token(sess, yytext); }
+| MOVE                       { $$ = mk_token(sess, yytext); }
+| MUT                        { $$ = mk_token(sess, yytext); }
+| OFFSETOF                   { $$ = mk_token(sess, yytext); }
+| OVERRIDE                   { $$ = mk_token(sess, yytext); }
+| PRIV                       { $$ = mk_token(sess, yytext); }
+| PUB                        { $$ = mk_token(sess, yytext); }
+| PURE                       { $$ = mk_token(sess, yytext); }
+| REF                        { $$ = mk_token(sess, yytext); }
+| RETURN                     { $$ = mk_token(sess, yytext); }
+| STRUCT                     { $$ = mk_token(sess, yytext); }
+| SIZEOF                     { $$ = mk_token(sess, yytext); }
+| SUPER                      { $$ = mk_token(sess, yytext); }
+| TRUE                       { $$ = mk_token(sess, yytext); }
+| TRAIT                      { $$ = mk_token(sess, yytext); }
+| TYPE                       { $$ = mk_token(sess, yytext); }
+| UNION                      { $$ = mk_token(sess, yytext); }
+| UNSAFE                     { $$ = mk_token(sess, yytext); }
+| UNSIZED                    { $$ = mk_token(sess, yytext); }
+| USE                        { $$ = mk_token(sess, yytext); }
+| VIRTUAL                    { $$ = mk_token(sess, yytext); }
+| WHILE                      { $$ = mk_token(sess, yytext); }
+| YIELD                      { $$ = mk_token(sess, yytext); }
+| CONTINUE                   { $$ = mk_token(sess, yytext); }
+| PROC                       { $$ = mk_token(sess, yytext); }
+| BOX                        { $$ = mk_token(sess, yytext); }
+| CONST                      { $$ = mk_token(sess, yytext); }
+| WHERE                      { $$ = mk_token(sess, yytext); }
+| TYPEOF                     { $$ = mk_token(sess, yytext); }
+| INNER_DOC_COMMENT          { $$ = mk_token(sess, yytext); }
+| OUTER_DOC_COMMENT          { $$ = mk_token(sess, yytext); }
+| SHEBANG                    { $$ = mk_token(sess, yytext); }
+| STATIC_LIFETIME            { $$ = mk_token(sess, yytext); }
+| ';'                        { $$ = mk_token(sess, yytext); }
+| ','                        { $$ = mk_token(sess, yytext); }
+| '.'                        { $$ = mk_token(sess, yytext); }
+| '@'                        { $$ = mk_token(sess, yytext); }
+| '#'                        { $$ = mk_token(sess, yytext); }
+| '~'                        { $$ = mk_token(sess, yytext); }
+| ':'                        { $$ = mk_token(sess, yytext); }
+| '$'                        { $$ = mk_token(sess, yytext); }
+| '='                        { $$ = mk_token(sess, yytext); }
+| '?'                        { $$ = mk_token(sess, yytext); }
+| '!'                        { $$ = mk_token(sess, yytext); }
+| '<'                        { $$ = mk_token(sess, yytext); }
+| '>'                        { $$ = mk_token(sess, yytext); }
+| '-'                        { $$ = mk_token(sess, yytext); }
+| '&'                        { $$ = mk_token(sess, yytext); }
+| '|'                        { $$ = mk_token(sess, yytext); }
+| '+'                        { $$ = mk_token(sess, yytext); }
+| '*'                        { $$ = mk_token(sess, yytext); }
+| '/'                        { $$ = mk_token(sess, yytext); }
+| '^'                        { $$ = mk_token(sess, yytext); }
+| '%'                        { $$ = mk_token(sess, yytext); }
 ;
 
 token_trees
-: %empty                     { $$ = mk_node("TokenTrees", 0); }
-| token_trees token_tree     { $$ = ext_node($1, 1, $2); }
+: %empty                     { $$ = mk_skip(sess, NK_TokenTrees, 0); }
+| token_trees token_tree     { $$ = ext_skip(sess, $1, 1, $2); }
 ;
 
 token_tree
 : delimited_token_trees
-| unpaired_token         { $$ = mk_node("TTTok", 1, $1); }
+| unpaired_token         { $$ = mk_skip(sess, NK_TTTok, 1, $1); }
 ;
 
 delimited_token_trees
@@ -1967,29 +2017,53 @@ delimited_token_trees
 parens_delimited_token_trees
 : '(' token_trees ')'
 {
-  $$ = mk_node("TTDelim", 3,
-               mk_node("TTTok", 1, mk_atom("(")),
+  $$ = mk_skip(sess, NK_TTDelim, 3,
+               mk_skip(sess, NK_TTTok, 1, mk_token(sess, "(")),
                $2,
-               mk_node("TTTok", 1, mk_atom(")")));
+               mk_skip(sess, NK_TTTok, 1, mk_token(sess, ")")));
 }
 ;
 
 braces_delimited_token_trees
 : '{' token_trees '}'
 {
-  $$ = mk_node("TTDelim", 3,
-               mk_node("TTTok", 1, mk_atom("{")),
+  $$ = mk_skip(sess, NK_TTDelim, 3,
+               mk_skip(sess, NK_TTTok, 1, mk_token(sess, "{")),
                $2,
-               mk_node("TTTok", 1, mk_atom("}")));
+               mk_skip(sess, NK_TTTok, 1, mk_token(sess, "}")));
 }
 ;
 
 brackets_delimited_token_trees
 : '[' token_trees ']'
 {
-  $$ = mk_node("TTDelim", 3,
-               mk_node("TTTok", 1, mk_atom("[")),
+  $$ = mk_skip(sess, NK_TTDelim, 3,
+               mk_skip(sess, NK_TTTok, 1, mk_token(sess, "[")),
                $2,
-               mk_node("TTTok", 1, mk_atom("]")));
+               mk_skip(sess, NK_TTTok, 1, mk_token(sess, "]")));
 }
 ;
+
+%%
+
+// The push parser of a check fed in pieces; see check_feed(). Returns
+// -1 while the parser wants more tokens, else what rsparse() would
+// have returned.
+int push_token(struct session *sess, int token, struct src_span *loc) {
+  if (!sess->push_parser) {
+    sess->push_parser = rspstate_new();
+  }
+  int ret = rspush_parse(sess->push_parser, token, NULL, loc, sess);
+  if (ret == YYPUSH_MORE) {
+    return -1;
+  }
+  push_parser_free(sess);
+  return ret;
+}
+
+void push_parser_free(struct session *sess) {
+  if (sess->push_parser) {
+    rspstate_delete(sess->push_parser);
+    sess->push_parser = NULL;
+  }
+}
@@ -1,686 +1,751 @@
 #include <cstdio>
-#include <cstdarg>
 #include <cstdlib>
 #include <cstring>
-#include <utility>
 #include <string>
-#include <map>
-#include <iostream>
-#include <iomanip>
 #include <vector>
-#include <sstream>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include "session.h"
+#include "source_map.h"
+#include "emit.h"
+#include "serve.h"
 
 using namespace std;
 
-extern int yylex();
-extern int rsparse();
-
-#define PUSHBACK_LEN 4
-
-static char pushback[PUSHBACK_LEN];
-static int verbose;
-
-map<string,string> id_map = {
-  {"i8","integer"},
-  {"i16","integer"},
-  {"i32","integer"},
-  {"i64","integer"},
-  {"u8","integer"},
-  {"u16","integer"},
-  {"u32","integer"},
-  {"u64","integer"},
-  {"f32","float"},
-  {"f64","float"},
-  {"LitStr","string"},
-  {"LitBool","bool"},
-  {"LitFloat","float"},
-  {"LitInteger","integer"},
-  {"bool", "bool"},
-  {"integer","integer"},
-  {"string","string"},
-  {"float","float"},
-  {"bool","bool"}
-};
+// Set by --emit-ast: save each file's tree next to it as <file>.ast.
+static int emit_ast;
+// Set by --stats: 1 for text, 2 for JSON, written to err after each file.
+static int stats;
 
-vector<string> semantic_errors;
+static void emit_ast_file(struct session *sess, char const *path) {
+  string ast_path = string(path) + ".ast";
+  FILE *f = fopen(ast_path.c_str(), "wb");
+  if (!f) {
+    fprintf(sess->err, "parser: cannot create %s: %s\n", ast_path.c_str(), strerror(errno));
+    return;
+  }
+  if (write_ast_file(sess, f) | fclose(f)) {
+    fprintf(sess->err, "parser: cannot write %s\n", ast_path.c_str());
+    remove(ast_path.c_str());
+  }
+}
 
+// With --trace-ring, the trace of a file is kept in memory and only
+// shown when the file has errors, or when the checker crashes.
+static struct session *traced;
 
-void print(const char* format, ...) {
-  va_list args;
-  va_start(args, format);
-  if (verbose) {
-    vprintf(format, args);
-  }
-  va_end(args);
+static void trace_crash(int sig) {
+  trace_dump_fd(&traced->trace, 2);
+  signal(sig, SIG_DFL);
+  raise(sig);
 }
 
-// If there is a non-null char at the head of the pushback queue,
-// dequeue it and shift the rest of the queue forwards. Otherwise,
-// return the token from calling yylex.
-int rslex() {
-  if (pushback[0] == '\0') {
-    return yylex();
-  } else {
-    char c = pushback[0];
-    memmove(pushback, pushback + 1, PUSHBACK_LEN - 1);
-    pushback[PUSHBACK_LEN - 1] = '\0';
-    return c;
+static void dump_trace(struct session *sess, int ret) {
+  if (sess->trace.ring && (ret || !sess->semantic_errors.empty())) {
+    trace_dump(&sess->trace, sess->err);
   }
+  trace_clear(&sess->trace);
 }
 
-// note: this does nothing if the pushback queue is full
-void push_back(char c) {
-  for (int i = 0; i < PUSHBACK_LEN; ++i) {
-    if (pushback[i] == '\0') {
-      pushback[i] = c;
-      break;
+// Regular files are mapped and scanned in place; anything that cannot
+// be mapped (a pipe, a FIFO) is parsed as it is read, like stdin.
+int check_file(struct session *sess, char const *path) {
+  struct source_map m;
+  FILE *in = NULL;
+  int ret = source_map_open(&m, path);
+  if (ret > 0) {
+    in = fopen(path, "r");
+    ret = in ? 0 : -1;
+  }
+  if (ret < 0) {
+    fprintf(sess->err, "parser: cannot open %s: %s\n", path, strerror(errno));
+    return 1;
+  }
+  sess->diag_file = path;
+  if (in) {
+    ret = check_stream(sess, in);
+    if (ret < 0) {
+      fprintf(sess->err, "parser: cannot read %s: %s\n", path, strerror(errno));
+      fclose(in);
+      return 1;
     }
+    fclose(in);
+  } else {
+    ret = check_source(sess, m.base, m.len);
   }
-}
-
-extern int rsdebug;
-
-struct node {
-  struct node *next;
-  struct node *prev;
-  int own_string;
-  char const *name;
-  int n_elems;
-  struct node *elems[];
-  // int line_no;
-};
-
-struct node *nodes = NULL;
-int n_nodes;
-
-struct node *mk_node(char const *name, int n, ...) {
-  va_list ap;
-  int i = 0;
-  unsigned sz = sizeof(struct node) + (n * sizeof(struct node *));
-  struct node *nn, *nd = (struct node *)malloc(sz);
-
-  print("# New %d-ary node: %s = %p\n", n, name, nd);
-
-  nd->own_string = 0;
-  nd->prev = NULL;
-  nd->next = nodes;
-  if (nodes) {
-    nodes->prev = nd;
+  dump_trace(sess, ret);
+  if (stats) {
+    write_stats(sess, sess->err, path, stats == 2);
   }
-  nodes = nd;
-
-  nd->name = name;
-  nd->n_elems = n;
-
-  va_start(ap, n);
-  while (i < n) {
-    nn = va_arg(ap, struct node *);
-    print("#   arg[%d]: %p\n", i, nn);
-    print("#            (%s ...)\n", nn->name);
-    nd->elems[i++] = nn;
+  if (emit_ast && ret == 0) {
+    emit_ast_file(sess, path);
   }
-  va_end(ap);
-  n_nodes++;
-  return nd;
-}
-
-struct node *mk_atom(char *name) {
-  struct node *nd = mk_node((char const *)strdup(name), 0);
-  nd->own_string = 1;
-  return nd;
-}
-
-struct node *mk_none() {
-  return mk_atom("<none>");
+  // Atoms point into the mapping, so drop the tree before unmapping.
+  session_reset(sess);
+  source_map_close(&m);
+  return ret;
 }
 
-struct node *ext_node(struct node *nd, int n, ...) {
-  va_list ap;
-  int i = 0, c = nd->n_elems + n;
-  unsigned sz = sizeof(struct node) + (c * sizeof(struct node *));
-  struct node *nn;
-
-  print("# Extending %d-ary node by %d nodes: %s = %p",
-        nd->n_elems, c, nd->name, nd);
-
-  if (nd->next) {
-    nd->next->prev = nd->prev;
+// stdin is parsed as it arrives, so a crate piped in from a slow
+// writer has its parse errors reported before the writer is done.
+static int check_stdin(struct session *sess) {
+  sess->diag_file = "<stdin>";
+  int ret = check_stream(sess, stdin);
+  if (ret < 0) {
+    fprintf(sess->err, "parser: cannot read stdin: %s\n", strerror(errno));
+    return 1;
   }
-  if (nd->prev) {
-    nd->prev->next = nd->next;
-  }
-  nd = (node*)realloc(nd, sz);
-  nd->prev = NULL;
-  nd->next = nodes;
-  nodes->prev = nd;
-  nodes = nd;
-
-  print(" ==> %p\n", nd);
-
-  va_start(ap, n);
-  while (i < n) {
-    nn = va_arg(ap, struct node *);
-    print("#   arg[%d]: %p\n", i, nn);
-    print("#            (%s ...)\n", nn->name);
-    nd->elems[nd->n_elems++] = nn;
-    ++i;
+  dump_trace(sess, ret);
+  if (stats) {
+    write_stats(sess, sess->err, "<stdin>", stats == 2);
   }
-  va_end(ap);
-  return nd;
+  session_reset(sess);
+  return ret;
 }
 
-/* Symbol Table definition 
-|--------|-------|--------|
-|--name--|-scope-|--type--|
-|--------|-------|--------| 
-name - Name of the identifier
-scope - pointer to the symbol table it is in (this or the child)
-type - data type if applicable
-*/
-struct sym_table{
-  struct sym_table* parent;
-  map<string, pair<struct sym_table*,string> > symbols;
+/* Batch mode. Files are handed out one at a time to a pool of forked
+   workers, each of which checks them with the ordinary single-crate
+   code and sends back the captured report. The parent prints reports
+   strictly in command-line order as soon as each one is complete. */
+struct batch_result {
+  int done;
+  int status;
+  string out;
+  string err;
 };
 
-bool insert_symbol(struct sym_table *table, string name, string type, struct sym_table *child){
-  // cout<<table<<"   "<<child<<"   "<<name<<endl;
-  // if(table!=child){
-  //   child=table;
-  // }
+struct batch_record {
+  int index;
+  int status;
+  size_t out_len;
+  size_t err_len;
+};
 
-  auto res_pair = table->symbols.insert(make_pair(name,make_pair(child,type)));
-  return res_pair.second;
+static int read_full(int fd, void *buf, size_t len) {
+  char *p = (char *)buf;
+  while (len) {
+    ssize_t r = read(fd, p, len);
+    if (r < 0 && errno == EINTR) {
+      continue;
+    }
+    if (r <= 0) {
+      return -1;
+    }
+    p += r;
+    len -= r;
+  }
+  return 0;
 }
 
-string lookup_table(struct sym_table *table, string name){
-  while(table && name.size()){
-    for(auto it = table->symbols.begin(); it!=table->symbols.end(); it++){
-      if(name==it->first){
-        return it->second.second;
-      }
+static int write_full(int fd, void const *buf, size_t len) {
+  char const *p = (char const *)buf;
+  while (len) {
+    ssize_t w = write(fd, p, len);
+    if (w < 0 && errno == EINTR) {
+      continue;
     }
-    //Static scoping
-    table = table->parent;
-  }
-  string empty;
-  stringstream ss;
-  ss<<"Identifier "<<name<<" not found"<<endl;
-  semantic_errors.push_back(ss.str());
-  return empty;
+    if (w <= 0) {
+      return -1;
+    }
+    p += w;
+    len -= w;
+  }
+  return 0;
 }
 
-struct sym_table *global_sym_table;
-
-
-int const indent_step = 4;
-
-void print_indent(int depth) {
-  while (depth) {
-    if (depth-- % indent_step == 0) {
-      print("|");
-    } else {
-      print(" ");
+static void batch_worker(struct session *sess, vector<char const *> const &files,
+                         int task_fd, int result_fd) {
+  int index;
+  while (read_full(task_fd, &index, sizeof(index)) == 0) {
+    char *out_buf = NULL, *err_buf = NULL;
+    size_t out_len = 0, err_len = 0;
+    sess->out = open_memstream(&out_buf, &out_len);
+    sess->err = open_memstream(&err_buf, &err_len);
+    int status = check_file(sess, files[index]);
+    fclose(sess->out);
+    fclose(sess->err);
+    struct batch_record rec = { index, status, out_len, err_len };
+    int failed = write_full(result_fd, &rec, sizeof(rec)) ||
+                 write_full(result_fd, out_buf, out_len) ||
+                 write_full(result_fd, err_buf, err_len);
+    free(out_buf);
+    free(err_buf);
+    if (failed) {
+      break;
     }
   }
 }
 
-string find_in_ast(struct node *n, string key){
-  string name;
-  if(!n){
-    return NULL;
+// Every diagnostic names its file, so only the report gets a header.
+static void print_header(struct session *sess, char const *path) {
+  if (sess->diag_format == DIAG_REPORT) {
+    fprintf(stdout, "==> %s <==\n", path);
   }
-  if(strcmp(n->name, key.c_str())==0){
-    string s (n->elems[0]->name);
-    return s;
-  }
-  for(int i=0;i<n->n_elems;i++){
-    name = find_in_ast(n->elems[i], key);
-    if(name.size()>0)
-      return name;
-  }
-  return name;
+}
 
+static void print_result(struct session *sess, char const *path, struct batch_result *r) {
+  print_header(sess, path);
+  fwrite(r->out.data(), 1, r->out.size(), stdout);
+  fflush(stdout);
+  fwrite(r->err.data(), 1, r->err.size(), stderr);
+  fflush(stderr);
+  r->out.clear();
+  r->out.shrink_to_fit();
+  r->err.clear();
+  r->err.shrink_to_fit();
 }
 
-int  expr_bin_type_check(struct sym_table *table, struct node *root, vector<string> &types){
-  //returns zero in case of error, 1 otherwise
+int run_batch(struct session *sess, vector<char const *> const &files, int jobs) {
+  int n = files.size();
+  vector<struct batch_result> results(n);
+  int ret = 0;
 
-  for(int i=0;i<root->n_elems;i++){
-    if(strcmp(root->elems[i]->name, "ExprBinary")==0){
-      int ret = expr_bin_type_check(table, root->elems[i], types);
-      if(!ret)
-        return ret;
+  if (jobs > n) {
+    jobs = n;
+  }
+  if (jobs <= 1) {
+    for (int i = 0; i < n; ++i) {
+      print_header(sess, files[i]);
+      fflush(stdout);
+      ret |= check_file(sess, files[i]);
+      fflush(stdout);
     }
-    else if(strcmp(root->elems[i]->name, "ExprPath")==0){
-      // ident 1
-      // cout<<root->elems[1]->name<<" "<<root->elems[2]->name<<endl;
-      
-      string ident = find_in_ast(root->elems[i], "ident");
-      string type = lookup_table(table, ident);
-      if(!type.size()){
-        return 0;
-      }
-      types.push_back(type);
-      // ident 2
-      // string ident2,type2;
-      // if(strcmp(root->elems[2]->name,"ExprLit")==0){
-      //   ident2 = find_in_ast(root->elems[2], "ExprLit");
-      //   type2 = id_map[ident2];
-      // }
-      // else if(strcmp(root->elems[2]->name,"ExprPath")==0){
-      //   ident2 = find_in_ast(root->elems[2], "ident");
-      //   //string lit = find_in_ast(root->elems[2],)
-      //   type2 = lookup_table(table, ident2);
-      // }
-      // if(!type2.size()){
-      //   return 0;
-      // }
-      // types.push_back(type2);
+    return ret;
+  }
+
+  vector<int> task_fds(jobs), result_fds(jobs), busy(jobs, -1);
+  vector<pid_t> pids(jobs);
+  fflush(stdout);
+  fflush(stderr);
+  for (int w = 0; w < jobs; ++w) {
+    int task[2], result[2];
+    if (pipe(task) || pipe(result)) {
+      perror("parser: pipe");
+      return 1;
+    }
+    pids[w] = fork();
+    if (pids[w] < 0) {
+      perror("parser: fork");
+      return 1;
     }
-    else if(strcmp(root->elems[i]->name, "ExprLit")==0){
-      string type = id_map[find_in_ast(root->elems[i],"ExprLit")];
-      // string type2 = id_map[find_in_ast(root->elems[i+1], "ExprLit")];
-      if(!type.size()){
-        return 0;
+    if (pids[w] == 0) {
+      close(task[1]);
+      close(result[0]);
+      // Drop the pipe ends inherited from earlier workers so their
+      // EOFs are not held open by this child.
+      for (int v = 0; v < w; ++v) {
+        close(task_fds[v]);
+        close(result_fds[v]);
       }
-      types.push_back(type);
+      batch_worker(sess, files, task[0], result[1]);
+      _exit(0);
     }
+    close(task[0]);
+    close(result[1]);
+    task_fds[w] = task[1];
+    result_fds[w] = result[0];
+  }
 
+  int next_task = 0, next_print = 0, live = jobs;
+  for (int w = 0; w < jobs; ++w) {
+    busy[w] = next_task;
+    write_full(task_fds[w], &next_task, sizeof(next_task));
+    next_task++;
   }
-  return 1;
-}
 
-int expr_flow_type_check(struct sym_table *table, struct node *n, vector<string> &types){
-  int flag=1;
-  if(strcmp(n->elems[1]->name, "ExprBinary")==0){
-    
-      int ret = expr_bin_type_check(table, n->elems[1],types);
-      if(!ret){
-        flag=0;
-        stringstream ss;
-        ss<<"Invalid types for binary operation in the flow control predicate"<<endl;
-        semantic_errors.push_back(ss.str());
+  vector<struct pollfd> fds(jobs);
+  while (live) {
+    for (int w = 0; w < jobs; ++w) {
+      fds[w].fd = result_fds[w];
+      fds[w].events = POLLIN;
+      fds[w].revents = 0;
+    }
+    if (poll(fds.data(), jobs, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      perror("parser: poll");
+      return 1;
+    }
+    for (int w = 0; w < jobs; ++w) {
+      if (!fds[w].revents) {
+        continue;
       }
-      else if(ret==1)
-      {
-        for(int i=0;i<types.size()-1;i++){
-          if(id_map[types[i]]!=id_map[types[i+1]]){
-            flag=0;
-            stringstream ss;
-            ss<<"Invalid types for binary operation in the flow control predicate"<<endl;
-            semantic_errors.push_back(ss.str());
+      struct batch_record rec;
+      if (read_full(result_fds[w], &rec, sizeof(rec)) == 0) {
+        struct batch_result &r = results[rec.index];
+        r.out.resize(rec.out_len);
+        r.err.resize(rec.err_len);
+        if (read_full(result_fds[w], &r.out[0], rec.out_len) == 0 &&
+            read_full(result_fds[w], &r.err[0], rec.err_len) == 0) {
+          r.status = rec.status;
+          r.done = 1;
+          busy[w] = -1;
+          if (next_task == n) {
+            // No work left: closing the task pipe lets the worker exit.
+            close(task_fds[w]);
+            task_fds[w] = -1;
+            continue;
+          }
+          if (write_full(task_fds[w], &next_task, sizeof(next_task)) == 0) {
+            busy[w] = next_task++;
+            continue;
           }
         }
       }
+      if (busy[w] >= 0) {
+        // The worker died mid-file; report it against that file.
+        struct batch_result &r = results[busy[w]];
+        r.status = 1;
+        r.err = "parser: worker crashed while checking this file\n";
+        r.done = 1;
+      }
+      if (task_fds[w] >= 0) {
+        close(task_fds[w]);
+        task_fds[w] = -1;
+      }
+      close(result_fds[w]);
+      result_fds[w] = -1;
+      live--;
+    }
+    while (next_print < n && results[next_print].done) {
+      ret |= results[next_print].status;
+      print_result(sess, files[next_print], &results[next_print]);
+      next_print++;
     }
+  }
 
-    return flag;
+  for (int w = 0; w < jobs; ++w) {
+    waitpid(pids[w], NULL, 0);
+  }
+  // Files left over when every worker died are checked in-process.
+  for (; next_print < n; ++next_print) {
+    if (!results[next_print].done) {
+      print_header(sess, files[next_print]);
+      fflush(stdout);
+      ret |= check_file(sess, files[next_print]);
+      fflush(stdout);
+    } else {
+      ret |= results[next_print].status;
+      print_result(sess, files[next_print], &results[next_print]);
+    }
+  }
+  return ret;
 }
-int global_flag=1;
-int build_sym_table(struct sym_table *table, struct node *n, struct sym_table *scope){
-  struct sym_table *new_scope=NULL;
-  
-  bool status;
-  if(strcmp(n->name, "ItemFn")==0){
-    new_scope= new sym_table();
-    new_scope->parent = table;
-    status=insert_symbol(table, n->elems[0]->elems[0]->name,"func_decl",new_scope);
-  }
-  else if(strcmp(n->name, "DeclLocal")==0){
-        int flag=1;
-        string name = find_in_ast(n->elems[0],"ident");
-        string type = find_in_ast(n->elems[1], "ident");
-
-        if(table->symbols.find(name)!=table->symbols.end())
-        {
-          flag=0;
-
-          stringstream ss;
-          ss<<"Redeclaration of "<<name<<endl;
-          semantic_errors.push_back(ss.str());
 
-        }
-        
-        else if(type.size()!=0&&id_map.find(type)==id_map.end())
-        {
-          flag=0;
-          stringstream ss;
-          ss<<"Invalid type "<<type<<" in declaration of "<<name<<endl;
-          semantic_errors.push_back(ss.str());
-
-        }
+/* Server mode; the protocol is in serve.h. A stream of requests is
+   served by one session, which keeps its arena blocks, scope tables,
+   interned names and, for SERVE_RECHECK, the last crate from one
+   request to the next. With a socket every client gets a thread and a
+   session from a pool of idle ones, so the sessions stay warm across
+   connections too. At most serve_max_clients are served at once;
+   others wait in the listen queue. */
+static struct session *serve_proto;
+static std::mutex serve_lock;
+static std::condition_variable serve_freed;
+static vector<struct session *> serve_idle;
+static int serve_clients;
+static int serve_max_clients = 32;
+static size_t serve_max_source = SERVE_MAX_SOURCE;
+static char const *serve_path;
+
+// The interned names only ever grow, so a session that has seen this
+// many starts over before its next request, recheck state and all.
+static unsigned const serve_max_names = 1u << 20;
+
+static int serve_reply(int fd, int status, char const *out, size_t out_len,
+                       char const *err, size_t err_len) {
+  struct serve_response rs;
+  memcpy(rs.magic, SERVE_RESPONSE_MAGIC, 4);
+  rs.status = status;
+  rs.out_len = out_len;
+  rs.err_len = err_len;
+  if (write_full(fd, &rs, sizeof(rs)) || write_full(fd, out, out_len) ||
+      write_full(fd, err, err_len)) {
+    return -1;
+  }
+  return 0;
+}
 
-        else
-        {
-          type = id_map[type];
-        if(strcmp(n->elems[2]->name,"ExprLit")==0){
-              string infer = find_in_ast(n->elems[2], "ExprLit");//inferred type
-              if(type.size()==0 && infer.size()!=0){
-                type = infer;
-              }
-              else if(type.size()==0&&infer.size()==0)
-                flag=0; //dont insert into symbol table
-              else{
-                if(id_map[type]!=id_map[infer]){
-                  flag=0;
-                  stringstream ss;
-                  ss<<"Declaration of "<<name<<" invalid, types mismatch"<<endl;
-                  semantic_errors.push_back(ss.str());
-                }
-              }
-        }
-        if(strcmp(n->elems[2]->name,"ExprPath")==0){
-          string infer = find_in_ast(n->elems[2],"ident");
-          infer = lookup_table(table,infer);
-          if(type.size()==0 && infer.size()!=0){
-                type = infer;
-              }
-              else if(type.size()==0&&infer.size()==0)
-                flag=0; //dont insert into symbol table
-              else{
-                if(id_map[type]!=id_map[infer]){
-                  flag=0;
-                  stringstream ss;
-                  ss<<"Declaration of "<<name<<" invalid, types mismatch"<<endl;
-                  semantic_errors.push_back(ss.str());
-                }
-              }
-        }
-        if(strcmp(n->elems[2]->name,"ExprBinary")==0){
-          vector<string> types;
-          int ret = expr_bin_type_check(table, n->elems[2], types);
-
-          int flag_no_right_type=1;
-          if(types.size()==0)
-          {
-            flag=0;
-            flag_no_right_type=0;
-            stringstream ss;
-            ss<<"Invalid declaration of "<<name<<endl;
-            semantic_errors.push_back(ss.str());
-
-            
-          }
-          
-          else
-          {
-          //fills the type vector with all the types of the 
-          // variables in the expression
-          //set flag according to ret
-            flag = flag && ret;
-            int rhs_type_flag=1;
-            if(ret==1)
-            {
-              for(int i=0;i<types.size()-1;i++){
-                if(id_map[types[i]]!=id_map[types[i+1]]){
-                  flag=0;
-                  rhs_type_flag=0;
-                  stringstream ss;
-                  ss<<"Expression involving declaration of "<<name<<" is invalid"<<endl;
-                  semantic_errors.push_back(ss.str());
-                }
-              }
-            }
-
-            // &&(type.size()!=0)&&(!(id_map[type]==types[0]))
-
-            if (rhs_type_flag)
-            {
-              if(type.size()==0)
-              {
-                type = types[0];
-              }
-
-              else if (id_map[type] != types[0])
-              {
-              flag=0;
-              stringstream ss;
-              ss<<"Type mis match in declaration of "<<name<<" LHS TYPE "<<type<<" RHS TYPE "<<types[0]<<endl;
-              semantic_errors.push_back(ss.str());
-              }
-            
-            }
-           }
-          }
+static int serve_refuse(int fd, char const *why) {
+  serve_reply(fd, -1, NULL, 0, why, strlen(why));
+  return -1;
+}
 
-        }
-        
-        if(flag)
-        {
-          
-          type = id_map[type];
-          status=insert_symbol(table, name, type, scope);
-        
-        }
+// Read, check and answer one request; -1 once the stream is done with.
+static int serve_one(struct session *sess, int in, int out, vector<char> &name, vector<char> &src) {
+  struct serve_request rq;
+  if (read_full(in, &rq, sizeof(rq))) {
+    return -1;
+  }
+  if (memcmp(rq.magic, SERVE_REQUEST_MAGIC, 4) || rq.version != SERVE_VERSION) {
+    return serve_refuse(out, "parser: bad request header\n");
+  }
+  if (rq.name_len > SERVE_MAX_NAME || rq.src_len > serve_max_source ||
+      rq.diag_format > DIAG_BINARY || rq.dump_format > DUMP_JSON) {
+    return serve_refuse(out, "parser: request out of range\n");
+  }
+  // The source is scanned in place, which needs two NULs after it.
+  name.resize(rq.name_len + 1);
+  src.resize(rq.src_len + 2);
+  if (read_full(in, name.data(), rq.name_len) || read_full(in, src.data(), rq.src_len)) {
+    return -1;
+  }
+  name[rq.name_len] = '\0';
+  src[rq.src_len] = src[rq.src_len + 1] = '\0';
+  if (sess->names.count > serve_max_names) {
+    session_reset(sess);
+    intern_free(&sess->names);
+  }
+
+  int st = rq.flags & SERVE_STATS_JSON ? 2 : rq.flags & SERVE_STATS ? 1 : stats;
+  char *out_buf = NULL, *err_buf = NULL;
+  size_t out_len = 0, err_len = 0;
+  sess->out = open_memstream(&out_buf, &out_len);
+  sess->err = open_memstream(&err_buf, &err_len);
+  sess->verbose = (rq.flags & SERVE_VERBOSE) != 0;
+  sess->trace.mask = serve_proto->trace.mask | (sess->verbose ? TRACE_PARSER | TRACE_NODES : 0);
+  sess->trace.level = sess->verbose && serve_proto->trace.level < 2 ? 2 : serve_proto->trace.level;
+  sess->parse_only = serve_proto->parse_only || (rq.flags & SERVE_PARSE_ONLY);
+  int check_only = serve_proto->check_only || (rq.flags & SERVE_CHECK_ONLY);
+  if (check_only != sess->check_only) {
+    // A recheck reuses items built in the other mode.
+    sess->incr_valid = 0;
+    sess->check_only = check_only;
+  }
+  sess->stats.enabled = st != 0;
+  sess->diag_format = rq.diag_format;
+  sess->dump_format = rq.dump_format;
+  sess->max_errors = rq.max_errors;
+  sess->diag_file = name.data();
+  int status;
+  if (rq.flags & SERVE_RECHECK) {
+    status = check_incremental(sess, src.data(), rq.src_len);
+  } else {
+    status = check_source(sess, src.data(), rq.src_len);
+  }
+  if (st) {
+    write_stats(sess, sess->err, name.data(), st == 2);
+  }
+  // Atoms point into src, which the next request overwrites.
+  if (!(rq.flags & SERVE_RECHECK)) {
+    session_reset(sess);
+  }
+  fclose(sess->out);
+  fclose(sess->err);
+  sess->out = sess->err = NULL;
+  int ret = serve_reply(out, status, out_buf, out_len, err_buf, err_len);
+  free(out_buf);
+  free(err_buf);
+  return ret;
+}
 
-        else
-        {
-          global_flag=0;
-        }
+static void serve_stream(struct session *sess, int in, int out) {
+  vector<char> name, src;
+  while (serve_one(sess, in, out, name, src) == 0) {
   }
+}
 
-  else if(strcmp(n->name,"ExprIf")==0){
-    vector<string> types;
-    int flag =expr_flow_type_check(table, n->elems[0],types);
-    if(flag==0)
-    {
-      global_flag=0;
+static void serve_connection(int fd) {
+  struct session *sess = NULL;
+  {
+    std::lock_guard<std::mutex> hold(serve_lock);
+    if (!serve_idle.empty()) {
+      sess = serve_idle.back();
+      serve_idle.pop_back();
     }
   }
+  if (!sess) {
+    sess = session_new();
+    sess->threads = serve_proto->threads;
+  }
+  serve_stream(sess, fd, fd);
+  close(fd);
+  session_reset(sess);
+  std::lock_guard<std::mutex> hold(serve_lock);
+  serve_idle.push_back(sess);
+  --serve_clients;
+  serve_freed.notify_one();
+}
 
-  else if(strcmp(n->name,"ExprWhile")==0){
-    vector<string> types;
-    int flag = expr_flow_type_check(table, n->elems[1],types); 
+static void serve_quit(int sig) {
+  unlink(serve_path);
+  _exit(128 + sig);
+}
 
-    if(flag==0)
-    {
-      global_flag=0;
+static int serve_socket(char const *path) {
+  struct sockaddr_un addr;
+  if (strlen(path) >= sizeof(addr.sun_path)) {
+    fprintf(stderr, "parser: socket path too long: %s\n", path);
+    return 1;
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, path);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    perror("parser: socket");
+    return 1;
+  }
+  // Take over a socket left behind by a server that is gone, but not
+  // one that is still being served or anything that is not a socket.
+  struct stat st;
+  if (stat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+      fprintf(stderr, "parser: %s is already being served\n", path);
+      close(fd);
+      return 1;
     }
+    unlink(path);
   }
-
-
-
-  else if(strcmp(n->name, "ExprAssign")==0){
-    int flag = 1;
-    string name = find_in_ast(n->elems[0],"ident");
-    string status = lookup_table(table, name);
-    if(!status.size())
-      flag=0;
-    else
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) || listen(fd, SOMAXCONN)) {
+    fprintf(stderr, "parser: cannot listen on %s: %s\n", path, strerror(errno));
+    close(fd);
+    return 1;
+  }
+  serve_path = path;
+  signal(SIGINT, serve_quit);
+  signal(SIGTERM, serve_quit);
+  for (;;) {
     {
-
-    string type, ident;
-    if(strcmp(n->elems[1]->name, "ExprLit")==0)
-      {
-        type = find_in_ast(n->elems[1], "ExprLit");
-        type = id_map[type];
-
-        if(status!=type && flag)
-        {
-          flag=0;
-          stringstream ss;
-          ss<<"Type mis match in assignement of "<<name<<" LHS TYPE "<<status<<" RHS TYPE "<<type<<endl;
-          semantic_errors.push_back(ss.str());
-
-        }
-
-      }
-    if(strcmp(n->elems[1]->name, "ExprPath")==0){
-      ident = find_in_ast(n->elems[1]->elems[0], "ident");
-      string type = lookup_table(table, ident);
-      if(!type.size())
-        flag=0;
+      std::unique_lock<std::mutex> hold(serve_lock);
+      serve_freed.wait(hold, [] { return serve_clients < serve_max_clients; });
     }
-    if(strcmp(n->elems[1]->name, "ExprBinary")==0){
-      vector<string> types;
-      int ret = expr_bin_type_check(table, n->elems[1],types);
-      if(!ret){
-        flag=0;
-        stringstream ss;
-        ss<<"Invalid types for binary operation during assignment of "<<name<<endl;
-        semantic_errors.push_back(ss.str());
-      }
-      else if(ret==1)
-      {
-        int rhs_type_flag=1; //rhs types are assumed to be valid
-        for(int i=0;i<types.size()-1;i++){
-          if(id_map[types[i]]!=id_map[types[i+1]]){
-            flag=0;
-            rhs_type_flag=0;
-            stringstream ss;
-            ss<<"Expression involving assignment of "<<name<<" is invalid"<<endl;
-            semantic_errors.push_back(ss.str());
-          }
-        }
-
-        if (rhs_type_flag&&!(status==types[0]))
-        {
-          flag=0;
-          stringstream ss;
-          ss<<"Type mismatch in assignement of "<<name<<" LHS TYPE "<<status<<" RHS TYPE "<<types[0]<<endl;
-          semantic_errors.push_back(ss.str());
-
-
-        }
-
-
+    int conn = accept(fd, NULL, NULL);
+    if (conn < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
       }
+      fprintf(stderr, "parser: accept: %s\n", strerror(errno));
+      break;
     }
-  }
-    if(flag){
-      
-      string type = id_map[status];
-      insert_symbol(table, name, id_map[type], scope);
-    }
-
-    else
     {
-     
-      global_flag=0;
+      std::lock_guard<std::mutex> hold(serve_lock);
+      ++serve_clients;
     }
+    std::thread(serve_connection, conn).detach();
   }
-  if(new_scope){
-    table = new_scope;
-    scope = new_scope;
-  }
-  for(int i=0;i<n->n_elems;i++){
-    build_sym_table(table, n->elems[i], scope);
-  }
-
-  return global_flag;
+  close(fd);
+  unlink(path);
+  return 1;
 }
 
-void print_symbol_table(struct sym_table *table, int depth){
-  for(auto it=table->symbols.begin(); it!=table->symbols.end();it++){
-    print_indent(depth);
-    cout<<setw(15)<<it->first<<setw(15)<<it->second.first<<setw(15)<<it->second.second<<endl;
-    if(it->second.first!=table){
-      print_symbol_table(it->second.first, depth+indent_step);
-    }
+// Serve requests on stdin and stdout, or on a Unix socket at path.
+int run_serve(struct session *sess, char const *path) {
+  signal(SIGPIPE, SIG_IGN);
+  serve_proto = sess;
+  if (!path) {
+    serve_stream(sess, 0, 1);
+    return 0;
   }
+  return serve_socket(path);
 }
 
-void print_node(struct node *n, int depth) {
-  int i = 0;
-  print_indent(depth);
-  if (n->n_elems == 0) {
-    print("%s\n", n->name);
-  } else {
-    print("(%s\n", n->name);
-    for (i = 0; i < n->n_elems; ++i) {
-      print_node(n->elems[i], depth + indent_step);
+static int read_file_list(char const *path, vector<string> &storage) {
+  FILE *f = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+  if (!f) {
+    fprintf(stderr, "parser: cannot open %s: %s\n", path, strerror(errno));
+    return -1;
+  }
+  char *line = NULL;
+  size_t cap = 0;
+  ssize_t len;
+  while ((len = getline(&line, &cap, f)) > 0) {
+    while (len && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+      line[--len] = '\0';
+    }
+    if (len) {
+      storage.push_back(line);
     }
-    print_indent(depth);
-    print(")\n");
   }
+  free(line);
+  if (f != stdin) {
+    fclose(f);
+  }
+  return 0;
 }
 
-void print_ast(struct node *n, int depth){
-  int i=0;
- // print_indent(depth);
-  if (strcmp(n->name,"ident") == 0) {
-    // cout<<"Printing depth-"<<depth<<endl;
-    print_indent(depth);
-    print("%s\n", n->elems[0]->name);
+static void usage() {
+  fprintf(stderr, "usage: parser [-v] [-j jobs] [-t threads] [--emit-ast] [--parse-only] [--files-from list]\n"
+                  "              [--check-only] [--diagnostics text|json|binary] [--max-errors n]\n"
+                  "              [--stats[=json]] [--dump text|sexpr|json] [--serve[=socket]]\n"
+                  "              [--serve-clients n] [--serve-max-source bytes]\n"
+                  "              [--trace parser,nodes,symtab,all[:level]] [--trace-ring bytes] [file.rs ...]\n"
+                  "With no files the crate is read from stdin. -j checks that many\n"
+                  "files at once; -t checks the function bodies of each on that many threads.\n"
+                  "--check-only leaves attributes and macro bodies out of the tree; the\n"
+                  "report is the same, but -v shows <skipped> for them.\n"
+                  "--diagnostics prints only the errors, in the given format.\n"
+                  "--dump sets how the symbol table and trees of the report are written.\n"
+                  "--trace-ring keeps the trace in memory and prints it for files with errors.\n"
+                  "--stats prints the time and memory each file took to stderr.\n"
+                  "--serve answers check requests (see serve.h) on stdin and stdout, or on\n"
+                  "a Unix socket, until the input ends or the server is killed. It serves up\n"
+                  "to --serve-clients connections at once (32) and sources of up to\n"
+                  "--serve-max-source bytes (64M).\n");
+}
 
+static int diag_format_of(char const *name) {
+  if (strcmp(name, "text") == 0) {
+    return DIAG_TEXT;
+  } else if (strcmp(name, "json") == 0) {
+    return DIAG_JSON;
+  } else if (strcmp(name, "binary") == 0) {
+    return DIAG_BINARY;
   }
-  else if (strcmp(n->name,"ExprLit") == 0)
-  {
-    print_indent(depth);
-    print("%s\n", n->elems[0]->elems[0]->name);
+  return -1;
+}
 
+static int dump_format_of(char const *name) {
+  if (strcmp(name, "text") == 0) {
+    return DUMP_TEXT;
+  } else if (strcmp(name, "sexpr") == 0) {
+    return DUMP_SEXPR;
+  } else if (strcmp(name, "json") == 0) {
+    return DUMP_JSON;
   }
-  else{
-    int step=0;
-    if(strcmp(n->name,"ExprBinary")==0){
-      print_indent(depth);
-      print("(%s\n",n->elems[0]->name);
-      step=indent_step;
-      // cout<<"Traversing step - "<<depth+step<<endl;
+  return -1;
+}
+
+int main(int argc, char **argv) {
+  vector<string> listed;
+  vector<char const *> files;
+  int jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  int threads = 1;
+  int verbose = 0;
+  int parse_only = 0;
+  int check_only = 0;
+  int diag_format = DIAG_REPORT;
+  int dump_format = DUMP_TEXT;
+  unsigned max_errors = 0;
+  char const *trace = NULL;
+  int serve = 0;
+  char const *serve_at = NULL;
+  size_t trace_ring_size = 0;
+  int ret = 0;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-v") == 0) {
+      verbose = 1;
+    } else if (strcmp(argv[i], "--emit-ast") == 0) {
+      emit_ast = 1;
+    } else if (strcmp(argv[i], "--parse-only") == 0) {
+      parse_only = 1;
+    } else if (strcmp(argv[i], "--check-only") == 0) {
+      check_only = 1;
+    } else if (strcmp(argv[i], "--stats") == 0) {
+      stats = 1;
+    } else if (strcmp(argv[i], "--stats=json") == 0) {
+      stats = 2;
+    } else if (strcmp(argv[i], "--serve") == 0) {
+      serve = 1;
+    } else if (strncmp(argv[i], "--serve=", 8) == 0 && argv[i][8]) {
+      serve = 1;
+      serve_at = argv[i] + 8;
+    } else if (strcmp(argv[i], "--serve-clients") == 0 && i + 1 < argc) {
+      serve_max_clients = atoi(argv[++i]);
+      if (serve_max_clients < 1) {
+        usage();
+        return 1;
+      }
+    } else if (strcmp(argv[i], "--serve-max-source") == 0 && i + 1 < argc) {
+      serve_max_source = strtoul(argv[++i], NULL, 0);
+      if (serve_max_source > UINT32_MAX - 2) {
+        usage();
+        return 1;
+      }
+    } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+      jobs = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      threads = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--diagnostics") == 0 && i + 1 < argc) {
+      diag_format = diag_format_of(argv[++i]);
+      if (diag_format < 0) {
+        usage();
+        return 1;
       }
-      for (i = 0; i < n->n_elems; ++i) {
-      print_ast(n->elems[i], depth + step);
+    } else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+      dump_format = dump_format_of(argv[++i]);
+      if (dump_format < 0) {
+        usage();
+        return 1;
       }
-      if(strcmp(n->name,"ExprBinary")==0){
-        // cout<<"Closing depth- "<<depth<<endl;
-      print_indent(depth);
-      print(")\n");
+    } else if (strcmp(argv[i], "--max-errors") == 0 && i + 1 < argc) {
+      max_errors = strtoul(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+      trace = argv[++i];
+    } else if (strcmp(argv[i], "--trace-ring") == 0 && i + 1 < argc) {
+      trace_ring_size = strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "--files-from") == 0 && i + 1 < argc) {
+      if (read_file_list(argv[++i], listed)) {
+        return 1;
+      }
+    } else if (argv[i][0] == '-' && argv[i][1]) {
+      usage();
+      return 1;
+    } else {
+      files.push_back(argv[i]);
     }
   }
-}
-
-void print_semantic_errors(){
-  for(auto i: semantic_errors){
-    cout<<i;
+  for (auto &f : listed) {
+    files.push_back(f.c_str());
   }
-}
-
-int main(int argc, char **argv) {
-  if (argc == 2 && strcmp(argv[1], "-v") == 0) {
-    verbose = 1;
-  } else {
-    verbose = 0;
+  if (serve && (!files.empty() || emit_ast)) {
+    fprintf(stderr, "parser: --serve takes no files\n");
+    return 1;
   }
-  int ret = 0;
-  struct node *tmp;
-  memset(pushback, '\0', PUSHBACK_LEN);
-  /* rsdebug = 1; */
-  global_sym_table = new sym_table();
-  global_sym_table->parent = NULL;
-  ret = rsparse();
-  print("--- PARSE COMPLETE: ret:%d, n_nodes:%d ---\n", ret, n_nodes);
-  if (nodes) {
-    print_node(nodes, 0);
-  }
-  if(ret==0)
-  {
-  printf("Building symbol table with root %p\n",global_sym_table);
-  int status = build_sym_table(global_sym_table, nodes, global_sym_table);
-  print_symbol_table(global_sym_table,0);
-  printf("No. of semantic errors : %ld\n",semantic_errors.size());
-  
-  print_semantic_errors();
-  
-
-  
-  if(status==1)
-  {
-    cout<<"Abstract Syntax Tree\n";
-    print_ast(nodes,0);
+  if (emit_ast && check_only) {
+    fprintf(stderr, "parser: --emit-ast needs the whole tree; drop --check-only\n");
+    return 1;
   }
+  if (emit_ast && files.empty()) {
+    fprintf(stderr, "parser: --emit-ast needs file arguments\n");
+    return 1;
   }
-  while (nodes) {
-    tmp = nodes;
-    nodes = tmp->next;
-    if (tmp->own_string) {
-      free((void*)tmp->name);
-    }
-    free(tmp);
+
+  struct session *sess = session_new();
+  sess->verbose = verbose;
+  if (verbose) {
+    sess->trace.mask = TRACE_PARSER | TRACE_NODES;
+    sess->trace.level = 2;
+  }
+  if (trace && trace_parse(&sess->trace, trace)) {
+    fprintf(stderr, "parser: bad --trace spec %s\n", trace);
+    session_free(sess);
+    return 1;
+  }
+  if (trace_ring_size) {
+    trace_ring(&sess->trace, trace_ring_size);
+    traced = sess;
+    signal(SIGSEGV, trace_crash);
+    signal(SIGBUS, trace_crash);
+    signal(SIGABRT, trace_crash);
+    signal(SIGFPE, trace_crash);
+  }
+  sess->threads = threads;
+  sess->parse_only = parse_only;
+  sess->check_only = check_only;
+  sess->stats.enabled = stats != 0;
+  sess->diag_format = diag_format;
+  sess->dump_format = dump_format;
+  sess->max_errors = max_errors;
+  if (serve) {
+    ret = run_serve(sess, serve_at);
+  } else if (files.empty()) {
+    ret = check_stdin(sess);
+  } else {
+    ret = run_batch(sess, files, jobs);
   }
+  session_free(sess);
   return ret;
 }
-
-void rserror(char const *s) {
-  fprintf (stderr, "%s\n", s);
-}
-
@@ -0,0 +1,88 @@
+#include "prescan.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define VEC_BYTES 32
+#define VEC_ALL 0xffffffffu
+typedef __m256i vec;
+#define vec_load(p) _mm256_loadu_si256((__m256i const *)(p))
+#define vec_splat(c) _mm256_set1_epi8(c)
+#define vec_eq(v, c) ((unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8((v), (c))))
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define VEC_BYTES 16
+#define VEC_ALL 0xffffu
+typedef __m128i vec;
+#define vec_load(p) _mm_loadu_si128((__m128i const *)(p))
+#define vec_splat(c) _mm_set1_epi8(c)
+#define vec_eq(v, c) ((unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8((v), (c))))
+#endif
+
+static int is_space(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+char *prescan_space(char *p, char *end, int *lines) {
+#ifdef VEC_BYTES
+  vec sp = vec_splat(' '), tab = vec_splat('\t');
+  vec cr = vec_splat('\r'), nl = vec_splat('\n');
+  while (end - p >= VEC_BYTES) {
+    vec v = vec_load(p);
+    unsigned nls = vec_eq(v, nl);
+    unsigned stop = ~(vec_eq(v, sp) | vec_eq(v, tab) | vec_eq(v, cr) | nls) & VEC_ALL;
+    if (stop) {
+      unsigned i = __builtin_ctz(stop);
+      *lines += __builtin_popcount(nls & ((1u << i) - 1));
+      return p + i;
+    }
+    *lines += __builtin_popcount(nls);
+    p += VEC_BYTES;
+  }
+#endif
+  for (; p < end && is_space(*p); ++p) {
+    *lines += *p == '\n';
+  }
+  return p;
+}
+
+/* Skip to the first a or b, counting newlines when lines is set. */
+static char *scan_until(char *p, char *end, char a, char b, int *lines) {
+#ifdef VEC_BYTES
+  vec va = vec_splat(a), vb = vec_splat(b), nl = vec_splat('\n');
+  while (end - p >= VEC_BYTES) {
+    vec v = vec_load(p);
+    unsigned stop = vec_eq(v, va) | vec_eq(v, vb);
+    unsigned nls = lines ? vec_eq(v, nl) : 0;
+    if (stop) {
+      unsigned i = __builtin_ctz(stop);
+      if (lines) {
+        *lines += __builtin_popcount(nls & ((1u << i) - 1));
+      }
+      return p + i;
+    }
+    if (lines) {
+      *lines += __builtin_popcount(nls);
+    }
+    p += VEC_BYTES;
+  }
+#endif
+  for (; p < end && *p != a && *p != b; ++p) {
+    if (lines) {
+      *lines += *p == '\n';
+    }
+  }
+  return p;
+}
+
+char *prescan_line(char *p, char *end, int *lines) {
+  (void)lines;
+  return scan_until(p, end, '\n', '\n', 0);
+}
+
+char *prescan_comment(char *p, char *end, int *lines) {
+  return scan_until(p, end, '*', '/', lines);
+}
+
+char *prescan_string(char *p, char *end, int *lines) {
+  return scan_until(p, end, '"', '\\', lines);
+}
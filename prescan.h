@@ -0,0 +1,23 @@
+#ifndef PRESCAN_H
+#define PRESCAN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Fast paths for the parts of the input the scanner would otherwise
+   match a byte at a time. Each returns the first byte in [p, end) the
+   named region does not cover (end if it runs to the end of the
+   buffer) and adds the newlines it skipped to *lines. They use 32-byte
+   AVX2 strides when built with -mavx2, 16-byte SSE2 strides on other
+   x86-64 builds and a plain loop elsewhere. */
+char *prescan_space(char *p, char *end, int *lines);    /* [ \t\r\n]* */
+char *prescan_line(char *p, char *end, int *lines);     /* up to '\n' */
+char *prescan_comment(char *p, char *end, int *lines);  /* up to '*' or '/' */
+char *prescan_string(char *p, char *end, int *lines);   /* up to '"' or '\\' */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef SEMANTICRS_H
+#define SEMANTICRS_H
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/* Embeddable interface to the checker behind bin/parser. A Session owns
+   all parser and checker state, so any number of sessions may run at
+   once as long as each is used by one thread at a time. */
+namespace semanticrs {
+
+enum diagnostic_kind {
+  DIAG_PARSE,
+  DIAG_SEMANTIC
+};
+
+struct diagnostic {
+  diagnostic_kind kind;
+  std::string message;
+  // "E0002" and so on; see diag.h.
+  std::string code;
+  // 1-based position of the start of the offending text.
+  int line;
+  int column;
+};
+
+// Layout of the dumps written to report; the same as parser --dump.
+enum dump_format {
+  DUMP_TEXT,   // one node per line, indented
+  DUMP_SEXPR,  // one S-expression per tree, on one line
+  DUMP_JSON    // one JSON value per tree, on one line
+};
+
+struct options {
+  // Also dump the parse tree to report, like `parser -v`.
+  int verbose;
+  // Receives the symbol table and AST dump bin/parser prints; NULL to
+  // only collect diagnostics.
+  FILE *report;
+  dump_format dump;
+  // Threads to check function bodies on.
+  int threads;
+  // Keep at most this many semantic errors; 0 keeps them all.
+  unsigned max_errors;
+  // Leave attributes and macro bodies out of the tree, like parser
+  // --check-only; the diagnostics are the same.
+  int check_only;
+
+  options()
+      : verbose(0), report(NULL), dump(DUMP_TEXT), threads(1), max_errors(0), check_only(0) {}
+};
+
+struct result {
+  // 0 when the buffer parsed; the semantic pass only runs then.
+  int parse_status;
+  // Nodes the parser allocated. After recheck() it is the number of
+  // nodes in the current tree instead, a shared node counted once per
+  // parent. That leaves out nodes the parser built and dropped, and
+  // counts check_only's shared placeholders more than once, so it is
+  // not what check() gives for the same buffer.
+  int n_nodes;
+  std::vector<diagnostic> diagnostics;
+  // Semantic errors past max_errors, which are not in diagnostics.
+  size_t errors_dropped;
+};
+
+class Session {
+public:
+  Session();
+  ~Session();
+
+  // Parse and check one crate held in memory. The session's tables
+  // are reset first, so a session can be reused for any number of
+  // buffers.
+  result check(char const *buf, size_t len, options const &opts = options());
+
+  // Check a new version of the buffer given to the last recheck(). Only
+  // the top-level items that changed are parsed and checked again; the
+  // result is the same as check() would return, except for n_nodes.
+  // check() and recheck() do not share state.
+  result recheck(char const *buf, size_t len, options const &opts = options());
+
+  // Check a crate that arrives in pieces, from a pipe or socket: begin(),
+  // feed() each piece as it comes, then finish(). Each piece is parsed
+  // as far as it goes. feed() returns true while the parser wants more
+  // and false once the parse is over, as it is as soon as the crate
+  // cannot parse; later pieces are ignored. finish() returns what
+  // check() of all the pieces at once would.
+  void begin(options const &opts = options());
+  bool feed(char const *buf, size_t len);
+  result finish();
+
+private:
+  Session(Session const &);
+  Session &operator=(Session const &);
+
+  struct session *sess;
+};
+
+// One-shot convenience wrapper around a temporary Session.
+result check(char const *buf, size_t len, options const &opts = options());
+
+}
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef SERVE_H
+#define SERVE_H
+
+#include <stdint.h>
+
+/* The protocol of parser --serve. A client writes requests and reads
+   back one response per request, in order, over one stream: the
+   server's stdin and stdout, or a connection to its Unix socket.
+
+   A request is a serve_request, then name_len bytes of file name,
+   which diagnostics are given under, then src_len bytes of source. A
+   response is a serve_response, then out_len bytes of report and
+   err_len bytes of error output, as parser would print them for that
+   file. All fields are in host byte order.
+
+   A request the server cannot read gets a response with status -1 and
+   the reason in err, and the server then closes the stream. */
+#define SERVE_REQUEST_MAGIC "RSRQ"
+#define SERVE_RESPONSE_MAGIC "RSRS"
+#define SERVE_VERSION 1
+
+enum serve_flag {
+  SERVE_VERBOSE = 1,     // like -v
+  SERVE_PARSE_ONLY = 2,  // like --parse-only
+  // Check incrementally against the previous request on the same
+  // stream, if that was a recheck too; the result is the same as a
+  // full check.
+  SERVE_RECHECK = 4,
+  SERVE_STATS = 8,       // like --stats, into err
+  SERVE_STATS_JSON = 16, // like --stats=json
+  SERVE_CHECK_ONLY = 32  // like --check-only
+};
+
+struct serve_request {
+  char magic[4];
+  uint32_t version;
+  uint32_t flags;
+  // As --diagnostics: 0 for the report, 1 text, 2 json, 3 binary.
+  uint32_t diag_format;
+  // As --dump: 0 text, 1 sexpr, 2 json.
+  uint32_t dump_format;
+  // As --max-errors; 0 keeps every error.
+  uint32_t max_errors;
+  uint32_t name_len;
+  uint32_t src_len;
+};
+
+struct serve_response {
+  char magic[4];
+  // What parser would exit with for the file alone.
+  int32_t status;
+  uint32_t out_len;
+  uint32_t err_len;
+};
+
+#define SERVE_MAX_NAME 4096
+// Longer sources are refused unless the server was started with a
+// higher --serve-max-source.
+#define SERVE_MAX_SOURCE (64u << 20)
+
+#endif
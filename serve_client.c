@@ -0,0 +1,324 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include "serve.h"
+
+/* Sends files to parser --serve and prints the answers as parser would
+   print the files' reports, so a server can be tried and timed with
+   nothing else running.
+
+   usage: serve_client [-s socket | -x parser] [-n rounds] [-j clients]
+                       [-r] [-c] [-v] [-q] [-d report|text|json|binary]
+                       [-D text|sexpr|json] file...
+
+   Without -s the client starts `parser --serve` itself (by default the
+   parser next to serve_client) and talks to it over pipes. -n sends
+   every file that many times and -j opens that many connections at
+   once (with -s only); only the first round of the first connection
+   is printed, and a timing line goes to stderr. -r asks for
+   incremental rechecks and -c for --check-only. */
+
+struct source {
+  char const *name;
+  char *text;
+  size_t len;
+};
+
+static struct source *sources;
+static int n_sources;
+static int rounds = 1;
+static uint32_t flags;
+static uint32_t diag_format;
+static uint32_t dump_format;
+static int quiet;
+static char const *socket_path;
+
+struct client {
+  int in;
+  int out;
+  int print;
+  int status;
+  pthread_t thread;
+};
+
+static int read_full(int fd, void *buf, size_t len) {
+  char *p = buf;
+  while (len) {
+    ssize_t r = read(fd, p, len);
+    if (r < 0 && errno == EINTR) {
+      continue;
+    }
+    if (r <= 0) {
+      return -1;
+    }
+    p += r;
+    len -= r;
+  }
+  return 0;
+}
+
+static int write_full(int fd, void const *buf, size_t len) {
+  char const *p = buf;
+  while (len) {
+    ssize_t w = write(fd, p, len);
+    if (w < 0 && errno == EINTR) {
+      continue;
+    }
+    if (w <= 0) {
+      return -1;
+    }
+    p += w;
+    len -= w;
+  }
+  return 0;
+}
+
+static int load(struct source *s, char const *path) {
+  FILE *f = fopen(path, "rb");
+  size_t cap = 65536;
+  s->name = path;
+  s->text = malloc(cap);
+  s->len = 0;
+  if (!f) {
+    fprintf(stderr, "serve_client: cannot open %s: %s\n", path, strerror(errno));
+    return -1;
+  }
+  for (;;) {
+    size_t r = fread(s->text + s->len, 1, cap - s->len, f);
+    s->len += r;
+    if (s->len < cap) {
+      break;
+    }
+    cap *= 2;
+    s->text = realloc(s->text, cap);
+  }
+  fclose(f);
+  return 0;
+}
+
+// Send one request and read its answer; -1 when the stream broke.
+static int ask(struct client *c, struct source const *s) {
+  struct serve_request rq;
+  struct serve_response rs;
+  memcpy(rq.magic, SERVE_REQUEST_MAGIC, 4);
+  rq.version = SERVE_VERSION;
+  rq.flags = flags;
+  rq.diag_format = diag_format;
+  rq.dump_format = dump_format;
+  rq.max_errors = 0;
+  rq.name_len = strlen(s->name);
+  rq.src_len = s->len;
+  if (write_full(c->out, &rq, sizeof(rq)) || write_full(c->out, s->name, rq.name_len) ||
+      write_full(c->out, s->text, s->len) || read_full(c->in, &rs, sizeof(rs)) ||
+      memcmp(rs.magic, SERVE_RESPONSE_MAGIC, 4)) {
+    return -1;
+  }
+  char *out = malloc(rs.out_len + 1), *err = malloc(rs.err_len + 1);
+  int ret = read_full(c->in, out, rs.out_len) || read_full(c->in, err, rs.err_len) ? -1 : 0;
+  if (ret == 0 && c->print) {
+    if (diag_format == 0) {
+      printf("==> %s <==\n", s->name);
+    }
+    fwrite(out, 1, rs.out_len, stdout);
+    fflush(stdout);
+    fwrite(err, 1, rs.err_len, stderr);
+  }
+  free(out);
+  free(err);
+  if (ret == 0) {
+    c->status |= rs.status < 0 ? 2 : rs.status;
+  }
+  return ret;
+}
+
+static void *run_client(void *arg) {
+  struct client *c = arg;
+  for (int r = 0; r < rounds; ++r) {
+    for (int i = 0; i < n_sources; ++i) {
+      if (ask(c, &sources[i])) {
+        fprintf(stderr, "serve_client: lost the server\n");
+        c->status = 2;
+        return NULL;
+      }
+    }
+    c->print = 0;
+  }
+  return NULL;
+}
+
+static int connect_to(char const *path) {
+  struct sockaddr_un addr;
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+  if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+    fprintf(stderr, "serve_client: cannot connect to %s: %s\n", path, strerror(errno));
+    return -1;
+  }
+  return fd;
+}
+
+// Start parser --serve with its stdin and stdout on pipes.
+static pid_t spawn(char const *parser, struct client *c) {
+  int to[2], from[2];
+  if (pipe(to) || pipe(from)) {
+    perror("serve_client: pipe");
+    return -1;
+  }
+  pid_t pid = fork();
+  if (pid == 0) {
+    dup2(to[0], 0);
+    dup2(from[1], 1);
+    close(to[0]);
+    close(to[1]);
+    close(from[0]);
+    close(from[1]);
+    execl(parser, parser, "--serve", (char *)NULL);
+    fprintf(stderr, "serve_client: cannot run %s: %s\n", parser, strerror(errno));
+    _exit(127);
+  }
+  close(to[0]);
+  close(from[1]);
+  c->out = to[1];
+  c->in = from[0];
+  return pid;
+}
+
+static int format_of(char const *name, char const *const *names, int n) {
+  for (int i = 0; i < n; ++i) {
+    if (strcmp(name, names[i]) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static double now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: serve_client [-s socket | -x parser] [-n rounds] [-j clients]\n"
+                  "                    [-r] [-c] [-v] [-q] [-d report|text|json|binary]\n"
+                  "                    [-D text|sexpr|json] file...\n");
+}
+
+int main(int argc, char **argv) {
+  static char const *const diag_names[] = { "report", "text", "json", "binary" };
+  static char const *const dump_names[] = { "text", "sexpr", "json" };
+  char parser[4096];
+  int jobs = 1;
+  int i;
+
+  // The parser next to this binary, unless -x says otherwise.
+  char const *slash = strrchr(argv[0], '/');
+  snprintf(parser, sizeof(parser), "%.*sparser", slash ? (int)(slash + 1 - argv[0]) : 0, argv[0]);
+
+  for (i = 1; i < argc && argv[i][0] == '-'; ++i) {
+    char opt = strlen(argv[i]) == 2 ? argv[i][1] : 0;
+    int f = -1;
+    if (opt == 'r') {
+      flags |= SERVE_RECHECK;
+      continue;
+    } else if (opt == 'c') {
+      flags |= SERVE_CHECK_ONLY;
+      continue;
+    } else if (opt == 'v') {
+      flags |= SERVE_VERBOSE;
+      continue;
+    } else if (opt == 'q') {
+      quiet = 1;
+      continue;
+    }
+    if (i + 1 == argc) {
+      usage();
+      return 2;
+    }
+    char const *arg = argv[++i];
+    switch (opt) {
+    case 's': socket_path = arg; break;
+    case 'x': snprintf(parser, sizeof(parser), "%s", arg); break;
+    case 'n': rounds = atoi(arg); break;
+    case 'j': jobs = atoi(arg); break;
+    case 'd':
+      f = format_of(arg, diag_names, 4);
+      diag_format = f;
+      break;
+    case 'D':
+      f = format_of(arg, dump_names, 3);
+      dump_format = f;
+      break;
+    default:
+      usage();
+      return 2;
+    }
+    if (((opt == 'd' || opt == 'D') && f < 0) || rounds < 1 || jobs < 1) {
+      usage();
+      return 2;
+    }
+  }
+  n_sources = argc - i;
+  if (n_sources <= 0 || (jobs > 1 && !socket_path)) {
+    usage();
+    return 2;
+  }
+  sources = calloc(n_sources, sizeof(*sources));
+  for (int k = 0; k < n_sources; ++k) {
+    if (load(&sources[k], argv[i + k])) {
+      return 2;
+    }
+  }
+  signal(SIGPIPE, SIG_IGN);
+
+  struct client *clients = calloc(jobs, sizeof(*clients));
+  pid_t server = 0;
+  for (int c = 0; c < jobs; ++c) {
+    clients[c].print = c == 0 && !quiet;
+    if (socket_path) {
+      clients[c].in = clients[c].out = connect_to(socket_path);
+      if (clients[c].in < 0) {
+        return 2;
+      }
+    } else if ((server = spawn(parser, &clients[c])) < 0) {
+      return 2;
+    }
+  }
+
+  double t0 = now_ms();
+  for (int c = 0; c < jobs; ++c) {
+    pthread_create(&clients[c].thread, NULL, run_client, &clients[c]);
+  }
+  int status = 0;
+  for (int c = 0; c < jobs; ++c) {
+    pthread_join(clients[c].thread, NULL);
+    status |= clients[c].status;
+    close(clients[c].out);
+    if (clients[c].in != clients[c].out) {
+      close(clients[c].in);
+    }
+  }
+  double t1 = now_ms();
+  if (server > 0) {
+    waitpid(server, NULL, 0);
+  }
+  if (rounds > 1 || jobs > 1 || quiet) {
+    long n = (long)rounds * n_sources * jobs;
+    fprintf(stderr, "serve_client: %ld requests in %.3f ms, %.1f per second\n",
+            n, t1 - t0, n / ((t1 - t0) / 1e3));
+  }
+  return status;
+}
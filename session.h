@@ -0,0 +1,315 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+
+#include "node_kinds.h"
+#include "lexer.h"
+#include "diag.h"
+#include "trace.h"
+
+/* Region allocator for the AST. Every node and atom string built while
+   parsing one crate is carved out of a chain of large blocks, and the
+   whole parse is released with a single arena_free(), or arena_reset()
+   to keep blocks for the next crate. */
+#define ARENA_BLOCK_SIZE (64 * 1024)
+#define ARENA_ALIGN 8
+// Blocks arena_reset() keeps; more than this are freed.
+#define ARENA_KEEP_BLOCKS 256
+
+struct arena_block {
+  struct arena_block *next;
+  size_t size;
+  size_t used;
+  char data[];
+};
+
+struct arena {
+  struct arena_block *head;
+  // Blocks of ARENA_BLOCK_SIZE left by arena_reset(), used before any
+  // new one is allocated.
+  struct arena_block *spare;
+  size_t n_spare;
+  size_t n_allocs;
+  size_t n_blocks;
+  size_t bytes_used;
+  size_t bytes_reserved;
+};
+
+void *arena_alloc(struct arena *a, size_t sz);
+char *arena_strdup(struct arena *a, char const *str);
+char *arena_strndup(struct arena *a, char const *str, size_t len);
+void arena_free(struct arena *a);
+void arena_reset(struct arena *a);
+
+/* Interned identifier names. Every name that reaches the symbol table
+   is mapped to one canonical copy, so scopes can hash and compare
+   names by pointer. */
+struct intern_table {
+  char const **slots;
+  unsigned cap;
+  unsigned count;
+  struct arena strings;
+};
+
+char const *intern(struct intern_table *names, char const *str, size_t len);
+void intern_free(struct intern_table *names);
+
+/* Besides its children, every node carries two slots the semantic
+   pass reads directly instead of searching the subtree:
+   ident - interned name of the first ident in the subtree, which is
+           the binding name of a pattern, the declared type of a type
+           ascription and the referenced name of an ExprPath
+   lit   - the first literal node (LitInteger, LitStr, ...) under an
+           ExprLit in the subtree
+   Both are filled in as the grammar actions build the tree.
+   LitInteger nodes also keep the value and suffix the scanner decoded
+   in int_lit.
+   An atom's name may point straight into a mapped source file and is
+   then not NUL-terminated; always use name_len with it.
+   start and end are the byte offsets of the text the node was reduced
+   from; line and column are only worked out for diagnostics. */
+struct node {
+  int kind;
+  int name_len;
+  char const *name;
+  char const *ident;
+  struct node *lit;
+  struct int_lit int_lit;
+  int n_elems;
+  int n_cap;
+  unsigned start;
+  unsigned end;
+  struct node *elems[];
+};
+/* Types the checker tells apart. The primitive widths are distinct
+   types, but each has a canonical type (integer, float, ...) that type
+   compatibility is decided on; see type_table in checker.cc. */
+enum type_id {
+  TY_NONE,
+  TY_INTEGER, TY_FLOAT, TY_STRING, TY_BOOL, TY_FUNC,
+  TY_I8, TY_I16, TY_I32, TY_I64,
+  TY_U8, TY_U16, TY_U32, TY_U64,
+  TY_F32, TY_F64,
+  TY_COUNT
+};
+
+/* Symbol Table definition 
+|--------|-------|--------|
+|--name--|-scope-|--type--|
+|--------|-------|--------| 
+name - Name of the identifier
+scope - pointer to the symbol table it is in (this or the child)
+type - data type if applicable, a type_id
+
+Each scope is a flat open-addressing table keyed by interned names,
+so a lookup is a pointer hash and compare per scope on the chain.
+*/
+struct sym_entry {
+  char const *name;
+  struct sym_table *scope;
+  int type;
+  // Insertion order within the table.
+  unsigned seq;
+};
+
+struct sym_table{
+  struct sym_table* parent;
+  std::vector<struct sym_entry> slots;
+  unsigned count;
+  // If set, every name inserted is also appended here.
+  std::vector<char const *> *log;
+};
+
+#define PUSHBACK_LEN 4
+
+/* Byte range of a token or grammar symbol, as offsets into the source
+   being scanned. Only known when the source is held in memory. */
+struct src_span {
+  size_t start;
+  size_t end;
+};
+
+/* A top-level item of the crate, as kept by check_incremental()
+   between calls. fp hashes the item's text; the check results are
+   only reused while the global scope the item is checked in hashes to
+   env, so a renamed function re-checks every item after it. */
+struct top_item {
+  struct src_span span;
+  unsigned long long fp;
+  struct node *node;
+  int n_nodes;
+
+  int checked;
+  unsigned long long env;
+  int flag;
+  // Start of the item when its nodes were built; errors are kept
+  // relative to it, since an edit before the item moves it.
+  size_t node_base;
+  std::vector<struct diag> errors;
+  size_t dropped;
+  // Entries the item added to the global scope, in insertion order.
+  std::vector<struct sym_entry> globals;
+};
+
+/* Where the time of one check went, filled in when enabled is set.
+   Lexing happens inside the parse, so parse_ns excludes lex_ns; the
+   counters are kept whether or not timing is on. */
+struct check_stats {
+  int enabled;
+  unsigned long long lex_ns;
+  unsigned long long parse_ns;
+  unsigned long long check_ns;
+  unsigned long long print_ns;
+  size_t ext_reallocs;
+  size_t lookups;
+  size_t scope_hops;
+};
+
+/* Everything one parse-and-check needs. Nothing in the checker is
+   global, so independent sessions can run on different threads. */
+struct rspstate;
+
+struct session {
+  yyscan_t scanner;
+  struct lex_extra lex;
+  char pushback[PUSHBACK_LEN];
+  // Source being scanned in place by check_source(), if any.
+  char const *src;
+  size_t src_len;
+  // Token spans are measured from scan_base and shifted by scan_offset;
+  // scan_base is NULL between scans.
+  char const *scan_base;
+  size_t scan_offset;
+  // Span of the grammar rule being reduced; new nodes take it.
+  struct src_span rule_span;
+
+  struct arena ast_arena;
+  struct node *ast_root;
+  int n_nodes;
+  // The shared <none> and placeholder nodes of check_only.
+  struct node *none;
+  std::unordered_map<char const *, struct node *> placeholders;
+
+  struct intern_table names;
+  std::deque<struct sym_table> scope_pool;
+  // Tables of scope_pool in use; the rest are kept for reuse.
+  size_t scopes_used = 0;
+  std::mutex scope_lock;
+  struct sym_table *global_sym_table;
+
+  std::vector<struct diag> parse_errors;
+  std::vector<struct diag> semantic_errors;
+  int global_flag;
+  // Semantic errors past the first max_errors (0: no limit) are only
+  // counted, in errors_dropped.
+  unsigned max_errors;
+  size_t errors_dropped;
+
+  // State check_incremental() keeps between calls: the last source
+  // text and its items, valid only while incr_valid is set. Spans of
+  // every item the parser reduces are collected in item_spans.
+  int incr_valid;
+  std::string incr_src;
+  std::vector<struct top_item> incr_items;
+  struct node *incr_attrs;
+  size_t incr_arena_live;
+  std::vector<struct top_item> item_spans;
+
+  // Copy of the text being scanned when the caller's buffer cannot be
+  // scanned in place.
+  std::vector<char> scan_buf;
+  // The parser's state, value and location stacks once they outgrow
+  // the ones it keeps on the native stack.
+  std::vector<char> parse_stacks[3];
+
+  // A check fed in pieces by check_feed(): every byte fed so far, the
+  // push parser, and where, in what start condition and how deep in
+  // block comments the scanner picks up again. The last scan stopped
+  // at stream_tried, inside a token that cannot end before
+  // stream_closer (empty for any byte) has arrived; the text up to
+  // stream_seen has been searched for it. stream_cut is the end of the
+  // last whole line.
+  std::string stream;
+  struct rspstate *push_parser;
+  size_t stream_pos;
+  size_t stream_tried;
+  size_t stream_seen;
+  size_t stream_cut;
+  int stream_state;
+  int stream_depth;
+  int stream_line;
+  std::string stream_closer;
+  // -1 while the parse goes on, then rsparse()'s status.
+  int stream_status;
+  struct src_span stream_loc;
+
+  // Threads to check function bodies on; 1 checks them in turn.
+  int threads;
+  // Stop after the parse: no symbol table, report or semantic errors.
+  int parse_only;
+  // Build only the parts of the tree the semantic pass reads; see
+  // mk_skip(). The report and diagnostics are those of a full build.
+  int check_only;
+  struct check_stats stats;
+
+  // Report destinations; out gets the symbol table and tree dumps,
+  // err gets parse errors as they happen. Either may be NULL.
+  int verbose;
+  struct trace trace;
+  FILE *out;
+  FILE *err;
+  // With any diag_format but DIAG_REPORT, out gets only the parse and
+  // semantic diagnostics in that format, named after diag_file.
+  int diag_format;
+  char const *diag_file;
+  // How the symbol table and tree dumps are written; see dump_format in semanticrs.h.
+  int dump_format;
+};
+
+struct session *session_new();
+void session_free(struct session *sess);
+void session_reset(struct session *sess);
+
+// Parse and check one crate, writing the report to sess->out. Returns
+// the parser's status: 0 when the crate parsed.
+// Returns -1 with errno set if in cannot be read.
+int check_stream(struct session *sess, FILE *in);
+int check_buffer(struct session *sess, char const *buf, size_t len);
+// Scan buf in place; buf[len] and buf[len + 1] must be NUL, and buf
+// must stay valid until the session is reset, since atoms point into
+// it. flex writes into buf while scanning.
+int check_source(struct session *sess, char *buf, size_t len);
+
+// Check a crate that arrives in pieces: check_begin(), check_feed()
+// for each piece, then check_finish(), which writes the report and
+// returns what check_buffer() of the whole text would. Each piece is
+// lexed and parsed as far as it completes tokens, so a parse error
+// reaches err before the input ends. check_feed() returns -1 while the
+// parser wants more input, then the parser's status once the parse is
+// over, when later pieces are ignored.
+void check_begin(struct session *sess);
+int check_feed(struct session *sess, char const *buf, size_t len);
+int check_finish(struct session *sess);
+
+// Check buf like check_buffer(), but keep the tree and the results of
+// every top-level item, so the next call only re-parses the part of
+// the text that changed and only re-checks the items in it. The report
+// and diagnostics are those a full check of buf would give. Any other
+// check or session_reset() drops the kept state.
+int check_incremental(struct session *sess, char const *buf, size_t len);
+
+// Write the stats of the last check of file, as text or as one line of
+// JSON.
+void write_stats(struct session *sess, FILE *out, char const *file, int json);
+
+// Write the tree of the last parse in the format of ast_file.h.
+// Returns -1 if there is no tree or the write fails.
+int write_ast_file(struct session *sess, FILE *out);
+
+#endif
@@ -0,0 +1,86 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "source_map.h"
+
+int source_map_open(struct source_map *m, char const *path) {
+  struct stat st;
+  size_t page = sysconf(_SC_PAGESIZE);
+  int fd = open(path, O_RDONLY);
+
+  memset(m, 0, sizeof(*m));
+  if (fd < 0) {
+    return -1;
+  }
+  if (fstat(fd, &st) || !S_ISREG(st.st_mode)) {
+    close(fd);
+    return 1;
+  }
+  m->len = st.st_size;
+  m->map_len = (m->len + 2 + page - 1) & ~(page - 1);
+
+  /* Reserve zeroed pages for the file plus sentinels, then lay the
+     file over the front. The tail of the file's last page reads as
+     zeros, as do the reserved pages after it. Both mappings are
+     private and writable because flex NUL-terminates yytext in place;
+     only pages it actually writes get copied. */
+  m->base = (char *)mmap(NULL, m->map_len, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (m->base == MAP_FAILED) {
+    close(fd);
+    m->base = NULL;
+    return 1;
+  }
+  if (m->len && mmap(m->base, m->len, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+    close(fd);
+    source_map_close(m);
+    return 1;
+  }
+  close(fd);
+  return 0;
+}
+
+int source_map_read(struct source_map *m, FILE *in) {
+  size_t cap = 1 << 16;
+
+  memset(m, 0, sizeof(*m));
+  m->base = (char *)malloc(cap);
+  while (m->base) {
+    m->len += fread(m->base + m->len, 1, cap - m->len - 2, in);
+    if (m->len < cap - 2) {
+      break;
+    }
+    char *grown = (char *)realloc(m->base, cap * 2);
+    if (!grown) {
+      free(m->base);
+    }
+    m->base = grown;
+    cap *= 2;
+  }
+  if (!m->base) {
+    m->len = 0;
+    errno = ENOMEM;
+    return -1;
+  }
+  if (ferror(in)) {
+    source_map_close(m);
+    return -1;
+  }
+  m->base[m->len] = m->base[m->len + 1] = '\0';
+  return 0;
+}
+
+void source_map_close(struct source_map *m) {
+  if (m->base && m->map_len) {
+    munmap(m->base, m->map_len);
+  } else {
+    free(m->base);
+  }
+  memset(m, 0, sizeof(*m));
+}
@@ -0,0 +1,34 @@
+#ifndef SOURCE_MAP_H
+#define SOURCE_MAP_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A source file mapped copy-on-write and followed by the two NUL bytes
+   flex's yy_scan_buffer() wants as end-of-buffer sentinels, so the
+   scanner can work on the file's pages directly. Input that cannot be
+   mapped can be read into a heap buffer laid out the same way; map_len
+   is 0 then. */
+struct source_map {
+  char *base;
+  size_t len;
+  size_t map_len;
+};
+
+/* Returns 0 on success, -1 with errno set if the file cannot be opened
+   and 1 if it cannot be mapped (a pipe, a tty, ...), in which case the
+   caller should read it with stdio instead. */
+int source_map_open(struct source_map *m, char const *path);
+/* Read all of in into a heap buffer. Returns 0, or -1 with errno set. */
+int source_map_read(struct source_map *m, FILE *in);
+void source_map_close(struct source_map *m);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
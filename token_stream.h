@@ -0,0 +1,48 @@
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Format of `lexer --binary`: a token_stream_header followed by one
+   token_record per token, all in host byte order. token is the value
+   from tokens.h (or the character itself for single-character
+   tokens), offset and len locate the token's text in the input in
+   bytes, and line is the line the token starts on. Doc comment
+   records do not include the trailing newline, as in the text
+   output. */
+
+#define TOKEN_STREAM_MAGIC "RSTK"
+#define TOKEN_STREAM_VERSION 1
+
+struct token_stream_header {
+  char magic[4];
+  uint32_t version;
+  uint32_t record_size;
+  uint32_t reserved;
+};
+
+struct token_record {
+  uint32_t token;
+  uint32_t offset;
+  uint32_t len;
+  uint32_t line;
+};
+
+/* Check the header of a stream held in memory (read or mapped whole)
+   and return its records, or NULL if data is not a token stream this
+   reader understands. */
+static inline struct token_record const *
+token_stream_records(void const *data, size_t size, size_t *count) {
+  struct token_stream_header const *h = (struct token_stream_header const *)data;
+  if (size < sizeof(*h) || memcmp(h->magic, TOKEN_STREAM_MAGIC, 4) != 0 ||
+      h->version != TOKEN_STREAM_VERSION ||
+      h->record_size != sizeof(struct token_record)) {
+    return NULL;
+  }
+  *count = (size - sizeof(*h)) / sizeof(struct token_record);
+  return (struct token_record const *)(h + 1);
+}
+
+#endif
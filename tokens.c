@@ -1,15 +1,11 @@
 #include <stdio.h>
-#include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "tokens.h"
+#include "lexer.h"
 
-extern char *yytext;
-
-static char *desugar_num(char*, char*);
-
-void print_token(int token) {
+void print_token(int token, char const *text) {
   switch (token) {
   case ';': printf("Semi"); break;
   case ',': printf("Comma"); break;
@@ -62,15 +58,15 @@ void print_token(int token) {
   case LARROW: printf("LArrow"); break;
   case RARROW: printf("RArrow"); break;
   case FAT_ARROW: printf("FatArrow"); break;
-  case LIT_BYTE: printf("Byte(%s)", yytext); break;
-  case LIT_CHAR: printf("Char(%s)", yytext); break;
-  case LIT_INTEGER: printf("Integer(%s)", yytext); break;
-  case LIT_FLOAT: printf("Float(%s)", yytext); break;
-  case LIT_STR: printf("Str(%s)", yytext); break;
-  case LIT_STR_RAW: printf("StrRaw(%s)", yytext); break;
-  case IDENT: printf("Ident(%s)", yytext); break;
+  case LIT_BYTE: printf("Byte(%s)", text); break;
+  case LIT_CHAR: printf("Char(%s)", text); break;
+  case LIT_INTEGER: printf("Integer(%s)", text); break;
+  case LIT_FLOAT: printf("Float(%s)", text); break;
+  case LIT_STR: printf("Str(%s)", text); break;
+  case LIT_STR_RAW: printf("StrRaw(%s)", text); break;
+  case IDENT: printf("Ident(%s)", text); break;
   case UNDERSCORE: printf("Underscore"); break;
-  case LIFETIME: printf("Lifetime(%s)", yytext); break;
+  case LIFETIME: printf("Lifetime(%s)", text); break;
   case SELF: printf("Ident(self)"); break;
   case STATIC: printf("Ident(static)"); break;
   case AS: printf("Ident(as)"); break;
@@ -125,97 +121,69 @@ void print_token(int token) {
   case CONST: printf("Ident(const)"); break;
   case WHERE: printf("Ident(where)"); break;
   case TYPEOF: printf("Ident(typeof)"); break;
-  case INNER_DOC_COMMENT: printf("DocComment(%s)", yytext); break;
-  case OUTER_DOC_COMMENT: printf("DocComment(%s)", yytext); break;
+  case INNER_DOC_COMMENT: printf("DocComment(%s)", text); break;
+  case OUTER_DOC_COMMENT: printf("DocComment(%s)", text); break;
   case SHEBANG: printf("Pound\nNot"); break;
-  case SHEBANG_LINE: printf("Shebang(%s)", yytext); break;
+  case SHEBANG_LINE: printf("Shebang(%s)", text); break;
   case STATIC_LIFETIME: printf("Lifetime('static)"); break;
   default: printf("can't print token %d", token); abort();
   }
   printf("\n");
 }
 
-static int hex_to_num(char c) {
-    if (c >= '0' && c <= '9') {
-        return c - '0';
-    } else if (c >= 'A' && c <= 'F') {
-        return c - 'A' + 10;
-    } else if (c >= 'a' && c <= 'f') {
-        return c - 'a' + 10;
-    } else {
-        printf("error: invalid hex digit '%c'\n", c);
-        abort();
-    }
+char const *const int_suffix_names[INT_SUFFIX_COUNT] = {
+  "", "i8", "i16", "i32", "i64", "i128", "isize",
+  "u8", "u16", "u32", "u64", "u128", "usize"
+};
+
+static int digit_value(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  } else if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  } else if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return 16;
 }
 
-static char *desugar_num(char *tok, char *default_suffix) {
-    int len = strlen(tok);
-    int start = 0;
-    int end;
-    long long int val = 0;
-    char *res = malloc(64);
+int decode_int(char const *text, int len, struct int_lit *lit) {
+  unsigned long long val = 0;
+  unsigned base = 10;
+  int i = 0;
 
-    if (tok[0] == '0') {
-        start = 2;
+  if (len > 2 && text[0] == '0') {
+    switch (text[1]) {
+    case 'x': base = 16; i = 2; break;
+    case 'o': base = 8; i = 2; break;
+    case 'b': base = 2; i = 2; break;
     }
+  }
 
-    for (int i = 0, k = 0; i < len; i++) {
-        if (tok[i] == '_') {
-            k = i + 1;
-            memmove(tok + i, tok + k, len - i);
-            len -= k - i;
-        }
+  lit->overflow = 0;
+  for (; i < len; ++i) {
+    unsigned d;
+    if (text[i] == '_') {
+      continue;
     }
-
-    end = len - 1;
-
-    for (int i = len; i > 0; i--) {
-        if (tok[i] == 'i' || tok[i] == 'u') {
-            end = i;
-            break;
-        }
+    d = digit_value(text[i]);
+    if (d >= base) {
+      break;
     }
-
-    if (tok[1] == 'b') {
-        for (int i = end, accum = 0; i >= start; i--, accum++) {
-            if (tok[i] == '_') {
-                accum--;
-                continue;
-            }
-            if (tok[i] == '1') {
-                val += (long long int) pow(2, accum);
-            }
-        }
-    } else if (tok[1] == 'x') {
-        for (int i = end, accum = 0; i >= start; i--, accum++) {
-            if (tok[i] == '_' || tok[i] == 'u' || tok[i] == 'i') {
-                accum--;
-                continue;
-            }
-            val += hex_to_num(tok[i]) * (long long int) pow(16, accum);
-        }
-    } else if (tok[1] == 'o') {
-        for (int i = end, accum = 0; i >= start; i--, accum++) {
-            if (tok[i] == '_') {
-                accum--;
-                continue;
-            }
-            val += (tok[i] - '0') * (long long int) pow(8, accum);
-        }
-    } else {
-        for (int i = end, accum = 0; i >= start; i--, accum++) {
-            if (tok[i] == '_') {
-                accum--;
-                continue;
-            }
-            val += (tok[i] - '0') * (long long int) pow(10, accum);
-        }
+    if (val > (~0ULL - d) / base) {
+      lit->overflow = 1;
     }
+    val = val * base + d;
+  }
+  lit->value = val;
 
-    if (default_suffix[0] == 'u') {
-        snprintf(res, 64, "%llu%s", val, (end == len -1) ? default_suffix : tok + end);
-    } else {
-        snprintf(res, 64, "%lld%s", val, (end == len -1) ? default_suffix : tok + end);
+  lit->suffix = INT_SUFFIX_NONE;
+  for (int s = 1; s < INT_SUFFIX_COUNT; ++s) {
+    if ((int)strlen(int_suffix_names[s]) == len - i &&
+        memcmp(text + i, int_suffix_names[s], len - i) == 0) {
+      lit->suffix = s;
+      break;
     }
-    return res;
+  }
+  return i;
 }
@@ -0,0 +1,121 @@
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+#include "trace.h"
+
+static void ring_put(struct trace *t, char const *s, size_t len) {
+  if (len >= t->ring_size) {
+    s += len - t->ring_size;
+    len = t->ring_size;
+  }
+  size_t first = t->ring_size - t->ring_pos;
+  if (first > len) {
+    first = len;
+  }
+  memcpy(t->ring + t->ring_pos, s, first);
+  memcpy(t->ring, s + first, len - first);
+  if (t->ring_pos + len >= t->ring_size) {
+    t->ring_wrapped = 1;
+  }
+  t->ring_pos = (t->ring_pos + len) % t->ring_size;
+}
+
+void trace_write(struct trace *t, FILE *out, char const *format, ...) {
+  va_list args;
+  va_start(args, format);
+  std::lock_guard<std::mutex> hold(t->lock);
+  if (t->ring) {
+    char line[512];
+    int len = vsnprintf(line, sizeof(line), format, args);
+    if (len >= (int)sizeof(line)) {
+      len = sizeof(line) - 1;
+    }
+    if (len > 0) {
+      ring_put(t, line, len);
+    }
+  } else if (out) {
+    vfprintf(out, format, args);
+  }
+  va_end(args);
+}
+
+void trace_ring(struct trace *t, size_t size) {
+  std::lock_guard<std::mutex> hold(t->lock);
+  free(t->ring);
+  t->ring = size ? (char *)malloc(size) : NULL;
+  t->ring_size = t->ring ? size : 0;
+  t->ring_pos = 0;
+  t->ring_wrapped = 0;
+}
+
+void trace_clear(struct trace *t) {
+  std::lock_guard<std::mutex> hold(t->lock);
+  t->ring_pos = 0;
+  t->ring_wrapped = 0;
+}
+
+void trace_dump(struct trace *t, FILE *out) {
+  std::lock_guard<std::mutex> hold(t->lock);
+  if (!t->ring) {
+    return;
+  }
+  if (t->ring_wrapped) {
+    fwrite(t->ring + t->ring_pos, 1, t->ring_size - t->ring_pos, out);
+  }
+  fwrite(t->ring, 1, t->ring_pos, out);
+}
+
+void trace_dump_fd(struct trace *t, int fd) {
+  if (!t->ring) {
+    return;
+  }
+  if (t->ring_wrapped && write(fd, t->ring + t->ring_pos, t->ring_size - t->ring_pos) < 0) {
+    return;
+  }
+  if (write(fd, t->ring, t->ring_pos) < 0) {
+    return;
+  }
+}
+
+int trace_parse(struct trace *t, char const *spec) {
+  static struct {
+    char const *name;
+    unsigned mask;
+  } const names[] = {
+    {"parser", TRACE_PARSER},
+    {"nodes", TRACE_NODES},
+    {"symtab", TRACE_SYMTAB},
+    {"all", TRACE_ALL}
+  };
+  unsigned mask = 0;
+  int level = 2;
+  char const *p = spec;
+  while (*p && *p != ':') {
+    size_t len = strcspn(p, ",:");
+    size_t i = 0;
+    while (i < sizeof(names) / sizeof(names[0]) &&
+           !(strlen(names[i].name) == len && strncmp(p, names[i].name, len) == 0)) {
+      ++i;
+    }
+    if (i == sizeof(names) / sizeof(names[0])) {
+      return -1;
+    }
+    mask |= names[i].mask;
+    p += len;
+    if (*p == ',') {
+      ++p;
+    }
+  }
+  if (*p == ':') {
+    char *end;
+    level = strtol(p + 1, &end, 10);
+    if (end == p + 1 || *end || level < 1) {
+      return -1;
+    }
+  }
+  t->mask = mask;
+  t->level = level;
+  return 0;
+}
@@ -0,0 +1,62 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdio>
+#include <cstddef>
+#include <mutex>
+
+/* Debug tracing. A trace site is a TRACE() with a category and a
+   level; its arguments are only evaluated when the session has that
+   category on at that level or above, so a disabled site costs one
+   test of the session's mask. Building with -DTRACE_LEVEL=0 (make
+   TRACE=0) drops every site from the binary; TRACE_LEVEL=1 keeps only
+   the per-phase ones. */
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL 2
+#endif
+
+enum trace_category {
+  TRACE_PARSER = 1,  // parse phases and arena use
+  TRACE_NODES = 2,   // every node built or extended
+  TRACE_SYMTAB = 4   // scopes, insertions and failed lookups
+};
+
+#define TRACE_ALL (TRACE_PARSER | TRACE_NODES | TRACE_SYMTAB)
+
+/* Trace lines go to the session's out stream or, once trace_ring()
+   has set one up, into a ring buffer holding the last ring_size bytes,
+   which trace_dump() writes out after an error. */
+struct trace {
+  unsigned mask;
+  int level;
+  char *ring;
+  size_t ring_size;
+  size_t ring_pos;
+  int ring_wrapped;
+  // Bodies checked on several threads trace at the same time.
+  std::mutex lock;
+};
+
+#define TRACE_ON(t, cat, lvl) \
+  ((lvl) <= TRACE_LEVEL && ((t)->mask & (cat)) && (lvl) <= (t)->level)
+
+#define TRACE(sess, cat, lvl, ...) do { \
+    if (TRACE_ON(&(sess)->trace, cat, lvl)) { \
+      trace_write(&(sess)->trace, (sess)->out, __VA_ARGS__); \
+    } \
+  } while (0)
+
+void trace_write(struct trace *t, FILE *out, char const *format, ...)
+  __attribute__((format(printf, 3, 4)));
+// Keep the last size bytes of trace in memory instead of writing them
+// to out; 0 goes back to writing them out.
+void trace_ring(struct trace *t, size_t size);
+void trace_clear(struct trace *t);
+// Write the ring's contents, oldest first.
+void trace_dump(struct trace *t, FILE *out);
+// Like trace_dump(), with only write(2), for use in a signal handler.
+void trace_dump_fd(struct trace *t, int fd);
+// Parse "parser,nodes:2" into t's mask and level; -1 if malformed.
+int trace_parse(struct trace *t, char const *spec);
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef WALK_H
+#define WALK_H
+
+#include <vector>
+
+#include "session.h"
+
+/* Depth-first walk of a tree on an explicit stack, so a deep tree (a
+   chain of thousands of ExprBinary, say) costs heap rather than native
+   stack.
+
+   Each node is visited with a State, a small value passed down the
+   tree. enter(n, own, inner) runs before n's children with inner set
+   to a copy of own. It may change inner, which is what the children
+   are visited with. It returns 1 to walk the children, 0 to skip them,
+   or -1 to stop the whole walk. leave(n, own) runs after the children
+   of every node that was entered, including skipped ones.
+
+   The stack is the caller's, so a hot walk can keep its storage
+   between calls. A hook may start another walk on the same stack; it
+   only ever grows above the frames of the outer walk. */
+template <typename State>
+struct walk_frame {
+  struct node *n;
+  int next;
+  State own;
+  State inner;
+};
+
+// Returns -1 if enter stopped the walk, else 0.
+template <typename State, typename Enter, typename Leave>
+int walk(std::vector<struct walk_frame<State> > &stack, struct node *root, State const &state,
+         Enter enter, Leave leave) {
+  size_t base = stack.size();
+  struct walk_frame<State> f;
+  f.n = root;
+  f.own = f.inner = state;
+  int r = enter(root, f.own, f.inner);
+  if (r < 0) {
+    return -1;
+  }
+  f.next = r ? 0 : root->n_elems;
+  stack.push_back(f);
+  while (stack.size() > base) {
+    // Hooks may push onto the stack and move it, so frames are only
+    // ever reached by index.
+    size_t top = stack.size() - 1;
+    struct node *n = stack[top].n;
+    if (stack[top].next < n->n_elems) {
+      f.n = n->elems[stack[top].next++];
+      f.own = f.inner = stack[top].inner;
+      r = enter(f.n, f.own, f.inner);
+      if (r < 0) {
+        stack.resize(base);
+        return -1;
+      }
+      f.next = r ? 0 : f.n->n_elems;
+      stack.push_back(f);
+    } else {
+      f.own = stack[top].own;
+      stack.pop_back();
+      leave(n, f.own);
+    }
+  }
+  return 0;
+}
+
+// For walks with nothing to pass down.
+struct walk_none {};
+
+#endif